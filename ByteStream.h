@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+// ============================================================
+//  Byte streams
+//
+//  Flat byte buffers for the packed co-save record and the
+//  compiled INI cache.  Integers are written as LEB128 varints
+//  (7 bits per byte, high bit set on all but the last byte), so
+//  the small deltas and indices that make up most of a save
+//  take one byte each.  Strings are a varint length followed by
+//  the raw bytes.
+//
+//  ByteReader never reads past its end.  On truncated or corrupt
+//  input it marks itself failed and returns zeros / empty
+//  strings from then on, so a decoder can check Ok() in its loop
+//  conditions instead of after every read.
+// ============================================================
+
+class ByteWriter
+{
+public:
+    void WriteVarint(UInt32 value)
+    {
+        WriteVarint64(value);
+    }
+
+    void WriteVarint64(UInt64 value)
+    {
+        while (value >= 0x80)
+        {
+            bytes.push_back(static_cast<UInt8>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<UInt8>(value));
+    }
+
+    void WriteString(std::string_view text)
+    {
+        WriteVarint(text.size());
+        bytes.insert(bytes.end(), text.begin(), text.end());
+    }
+
+    const UInt8* Data() const { return bytes.data(); }
+    UInt32 Size() const { return bytes.size(); }
+
+private:
+    std::vector<UInt8> bytes;
+};
+
+class ByteReader
+{
+public:
+    ByteReader(const UInt8* data, UInt32 size) : data(data), size(size), pos(0), failed(false) {}
+
+    UInt32 ReadVarint()
+    {
+        UInt64 value = ReadVarint64();
+        if (value > 0xFFFFFFFF) return Fail();
+        return static_cast<UInt32>(value);
+    }
+
+    UInt64 ReadVarint64()
+    {
+        UInt64 value = 0;
+        for (UInt32 shift = 0; shift < 70; shift += 7)
+        {
+            if (pos >= size) break;
+
+            UInt8 byte = data[pos++];
+            value |= static_cast<UInt64>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        return Fail();
+    }
+
+    std::string_view ReadString()
+    {
+        UInt32 length = ReadVarint();
+        if (length > size - pos)
+        {
+            Fail();
+            return std::string_view();
+        }
+
+        std::string_view text(reinterpret_cast<const char*>(data + pos), length);
+        pos += length;
+        return text;
+    }
+
+    // Marks the stream corrupt; always returns 0
+    UInt32 Fail()
+    {
+        failed = true;
+        pos = size;
+        return 0;
+    }
+
+    bool Ok() const { return !failed; }
+    bool AtEnd() const { return pos == size; }
+    UInt32 Remaining() const { return size - pos; }
+
+private:
+    const UInt8* data;
+    UInt32       size;
+    UInt32       pos;
+    bool         failed;
+};
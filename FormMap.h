@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// ============================================================
+//  FormMap
+//
+//  Open-addressing hash map keyed by form ID, used for the
+//  per-form keyword tables.  Slots are stored inline in one
+//  array and probed linearly, so a lookup is usually a single
+//  cache line instead of a walk down a node-based tree.
+//
+//  Form ID 0 marks an empty slot and cannot be used as a key.
+//  Erase uses backward-shift deletion, so there are no
+//  tombstones and probe chains never degrade over time.
+//
+//  Iteration order is unspecified; use SortedKeys() where a
+//  stable order matters (e.g. when writing the co-save).
+//  Pointers returned by Find() are invalidated by any insert
+//  or erase.
+// ============================================================
+
+template <class T>
+class FormMap
+{
+public:
+    FormMap() : numEntries(0) {}
+
+    // Murmur3 finalizer.  Oblivion form IDs keep the mod index in the high
+    // byte and mostly sequential IDs in the low bytes, so the bits need a
+    // full avalanche before they are masked down to a slot index.
+    static UInt32 Hash(UInt32 formID)
+    {
+        formID ^= formID >> 16;
+        formID *= 0x85ebca6b;
+        formID ^= formID >> 13;
+        formID *= 0xc2b2ae35;
+        formID ^= formID >> 16;
+        return formID;
+    }
+
+    T* Find(UInt32 formID)
+    {
+        if (!formID || slots.empty()) return nullptr;
+
+        for (UInt32 i = Hash(formID) & Mask(); ; i = (i + 1) & Mask())
+        {
+            if (slots[i].formID == formID) return &slots[i].value;
+            if (slots[i].formID == 0) return nullptr;
+        }
+    }
+
+    const T* Find(UInt32 formID) const
+    {
+        return const_cast<FormMap*>(this)->Find(formID);
+    }
+
+    // Returns the value for formID, default-constructing it if missing
+    T& operator[](UInt32 formID)
+    {
+        if ((numEntries + 1) * 4 > slots.size() * 3)
+        {
+            Rehash(slots.empty() ? 16 : slots.size() * 2);
+        }
+
+        UInt32 i = Hash(formID) & Mask();
+        while (slots[i].formID != 0)
+        {
+            if (slots[i].formID == formID) return slots[i].value;
+            i = (i + 1) & Mask();
+        }
+
+        slots[i].formID = formID;
+        ++numEntries;
+        return slots[i].value;
+    }
+
+    bool Erase(UInt32 formID)
+    {
+        if (!formID || slots.empty()) return false;
+
+        UInt32 i = Hash(formID) & Mask();
+        while (slots[i].formID != formID)
+        {
+            if (slots[i].formID == 0) return false;
+            i = (i + 1) & Mask();
+        }
+
+        // Shift later members of the probe chain back into the hole
+        UInt32 hole = i;
+        for (UInt32 j = (i + 1) & Mask(); slots[j].formID != 0; j = (j + 1) & Mask())
+        {
+            UInt32 home = Hash(slots[j].formID) & Mask();
+            if (((j - home) & Mask()) >= ((j - hole) & Mask()))
+            {
+                slots[hole] = std::move(slots[j]);
+                hole = j;
+            }
+        }
+
+        slots[hole] = Slot();
+        --numEntries;
+        return true;
+    }
+
+    void Clear()
+    {
+        slots.clear();
+        numEntries = 0;
+    }
+
+    void Reserve(UInt32 count)
+    {
+        UInt32 capacity = 16;
+        while (count * 4 > capacity * 3)
+        {
+            capacity *= 2;
+        }
+        if (capacity > slots.size())
+        {
+            Rehash(capacity);
+        }
+    }
+
+    UInt32 Size() const { return numEntries; }
+    bool Empty() const { return numEntries == 0; }
+    UInt32 TableBytes() const { return slots.capacity() * sizeof(Slot); }
+
+    // Calls func(formID, value) for every entry, in slot order
+    template <class Func>
+    void ForEach(Func&& func) const
+    {
+        for (const auto& slot : slots)
+        {
+            if (slot.formID) func(slot.formID, slot.value);
+        }
+    }
+
+    std::vector<UInt32> SortedKeys() const
+    {
+        std::vector<UInt32> keys;
+        keys.reserve(numEntries);
+        ForEach([&](UInt32 formID, const T&) { keys.push_back(formID); });
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+private:
+    struct Slot
+    {
+        UInt32 formID = 0;
+        T      value;
+    };
+
+    UInt32 Mask() const { return slots.size() - 1; }
+
+    void Rehash(UInt32 capacity)
+    {
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.resize(capacity);
+
+        for (auto& slot : old)
+        {
+            if (!slot.formID) continue;
+
+            UInt32 i = Hash(slot.formID) & Mask();
+            while (slots[i].formID != 0)
+            {
+                i = (i + 1) & Mask();
+            }
+            slots[i] = std::move(slot);
+        }
+    }
+
+    std::vector<Slot> slots;    // power-of-two sized
+    UInt32            numEntries;
+};
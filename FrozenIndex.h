@@ -0,0 +1,308 @@
+#pragma once
+
+#include "FormMap.h"
+#include "KeywordSet.h"
+#include <algorithm>
+#include <vector>
+
+// ============================================================
+//  Frozen keyword index
+//
+//  Read-only form <-> keyword index for keywords that do not
+//  change once loaded (the INI layer).  Both directions are
+//  stored in compressed sparse row (CSR) form: a sorted row
+//  array of (key, offset) pairs and one flat value array.  A
+//  tag costs 4 bytes in each direction and a form 8 bytes, with
+//  no per-form allocations or empty hash slots.
+//
+//  Form lookups binary search a sample of every 8th form ID,
+//  which is small enough to stay in cache, then scan the one
+//  cache line of rows it points to.  Both steps are branch-free,
+//  so a lookup costs a few cache misses and no mispredictions
+//  however the form IDs are spread.
+// ============================================================
+
+// Read-only view of a sorted keyword ID list, with the query
+// interface of KeywordSet
+class KeywordSpan
+{
+public:
+    KeywordSpan() : ids(nullptr), size(0) {}
+    KeywordSpan(const UInt32* ids, UInt32 size) : ids(ids), size(size) {}
+
+    bool Contains(UInt32 keywordID) const
+    {
+        return std::binary_search(ids, ids + size, keywordID);
+    }
+
+    const UInt32* Data() const { return ids; }
+    UInt32 Size() const { return size; }
+    bool Empty() const { return size == 0; }
+
+    // Calls func(keywordID) in ascending ID order
+    template <class Func>
+    void ForEach(Func&& func) const
+    {
+        for (UInt32 i = 0; i < size; ++i)
+        {
+            func(ids[i]);
+        }
+    }
+
+    bool ContainsAny(const KeywordMask& mask) const
+    {
+        for (UInt32 i = 0; i < size; ++i)
+        {
+            if (mask.Test(ids[i])) return true;
+        }
+        return false;
+    }
+
+    bool ContainsAll(const KeywordMask& mask) const
+    {
+        // IDs are unique, so matching mask.Count() of them means all are present
+        UInt32 matched = 0;
+        for (UInt32 i = 0; i < size; ++i)
+        {
+            matched += mask.Test(ids[i]);
+        }
+        return matched == mask.Count();
+    }
+
+private:
+    const UInt32* ids;
+    UInt32        size;
+};
+
+class FrozenKeywordIndex
+{
+public:
+    // Replaces the index with the contents of formKeywords.  Keyword IDs
+    // must be below numKeywordIDs.
+    void Build(const FormMap<KeywordSet>& formKeywords, UInt32 numKeywordIDs)
+    {
+        Clear();
+        std::vector<UInt32> formIDs = formKeywords.SortedKeys();
+
+        formRows.reserve(formIDs.size() + 1);
+        for (UInt32 formID : formIDs)
+        {
+            formRows.push_back({ formID, static_cast<UInt32>(keywordIDs.size()) });
+            formKeywords.Find(formID)->ForEach([&](UInt32 keywordID) {
+                keywordIDs.push_back(keywordID);
+                });
+        }
+        BuildReverse(numKeywordIDs);
+    }
+
+    // Rebuilds the index as its current contents plus added minus removed,
+    // both sorted (formID << 32 | keywordID) pairs.  One merge pass over
+    // the forward rows, so a small patch costs a fraction of a Build.
+    void Patch(const std::vector<UInt64>& added, const std::vector<UInt64>& removed, UInt32 numKeywordIDs)
+    {
+        std::vector<Row> oldRows;
+        std::vector<UInt32> oldIDs;
+        oldRows.swap(formRows);
+        oldIDs.swap(keywordIDs);
+        Clear();
+
+        formRows.reserve(oldRows.size() + added.size());
+        keywordIDs.reserve(oldIDs.size() + added.size());
+
+        std::size_t nextRemoved = 0;
+        auto emit = [&](UInt64 pair) {
+            while (nextRemoved < removed.size() && removed[nextRemoved] < pair) ++nextRemoved;
+            if (nextRemoved < removed.size() && removed[nextRemoved] == pair) return;
+
+            UInt32 formID = static_cast<UInt32>(pair >> 32);
+            UInt32 keywordID = static_cast<UInt32>(pair);
+            if (formRows.empty() || formRows.back().formID != formID)
+            {
+                formRows.push_back({ formID, static_cast<UInt32>(keywordIDs.size()) });
+            }
+            else if (keywordIDs.back() == keywordID)
+            {
+                return;     // added pair already present
+            }
+            keywordIDs.push_back(keywordID);
+            };
+
+        UInt32 numOldForms = oldRows.empty() ? 0 : oldRows.size() - 1;
+        UInt32 row = 0, pos = 0;
+        std::size_t nextAdded = 0;
+        for (;;)
+        {
+            while (row < numOldForms && pos == oldRows[row + 1].offset) ++row;
+
+            bool haveOld = row < numOldForms;
+            bool haveAdded = nextAdded < added.size();
+            if (!haveOld && !haveAdded) break;
+
+            UInt64 oldPair = haveOld ? (static_cast<UInt64>(oldRows[row].formID) << 32) | oldIDs[pos] : 0;
+            if (haveAdded && (!haveOld || added[nextAdded] <= oldPair))
+            {
+                emit(added[nextAdded++]);
+            }
+            else
+            {
+                emit(oldPair);
+                ++pos;
+            }
+        }
+
+        BuildReverse(numKeywordIDs);
+    }
+
+    void Clear()
+    {
+        // Swap with empty vectors so the memory is actually released
+        std::vector<Row>().swap(formRows);
+        std::vector<UInt32>().swap(keywordIDs);
+        std::vector<UInt32>().swap(formOffsets);
+        std::vector<UInt32>().swap(forms);
+        std::vector<UInt32>().swap(blockFirst);
+    }
+
+    // Keywords of formID; empty if the form has none
+    KeywordSpan Find(UInt32 formID) const
+    {
+        UInt32 row = FindRow(formID);
+        if (row == kNotFound) return KeywordSpan();
+        return GetRow(row);
+    }
+
+    // Sorted form IDs that have keywordID; outCount is 0 if there are none
+    const UInt32* GetForms(UInt32 keywordID, UInt32& outCount) const
+    {
+        // keywordID + 1 would wrap for 0xFFFFFFFF
+        if (formOffsets.empty() || keywordID >= formOffsets.size() - 1)
+        {
+            outCount = 0;
+            return nullptr;
+        }
+        outCount = formOffsets[keywordID + 1] - formOffsets[keywordID];
+        return forms.data() + formOffsets[keywordID];
+    }
+
+    UInt32 CountForms(UInt32 keywordID) const
+    {
+        UInt32 count;
+        GetForms(keywordID, count);
+        return count;
+    }
+
+    // Calls func(formID, keywords) for every form, in ascending ID order
+    template <class Func>
+    void ForEach(Func&& func) const
+    {
+        for (UInt32 row = 0; row < NumForms(); ++row)
+        {
+            func(formRows[row].formID, GetRow(row));
+        }
+    }
+
+    UInt32 NumForms() const { return formRows.empty() ? 0 : formRows.size() - 1; }
+    UInt32 NumTags() const { return keywordIDs.size(); }
+
+    UInt32 Bytes() const
+    {
+        return formRows.capacity() * sizeof(Row)
+            + (keywordIDs.capacity() + formOffsets.capacity() + forms.capacity()
+                + blockFirst.capacity()) * sizeof(UInt32);
+    }
+
+private:
+    static const UInt32 kNotFound = 0xFFFFFFFF;
+    static const UInt32 kBlockSize = 8;     // one cache line of rows
+
+    struct Row
+    {
+        UInt32 formID;
+        UInt32 offset;      // first keyword in keywordIDs
+    };
+
+    // Finishes a Build or Patch from the forward rows: adds the sentinel
+    // row, then fills in the reverse rows and the block sample
+    void BuildReverse(UInt32 numKeywordIDs)
+    {
+        formRows.push_back({ 0, static_cast<UInt32>(keywordIDs.size()) });
+        formRows.shrink_to_fit();
+        keywordIDs.shrink_to_fit();
+
+        // Forms are visited in ascending ID order, so every reverse row
+        // comes out sorted
+        std::vector<UInt32> offsets(numKeywordIDs + 1, 0);
+        for (UInt32 keywordID : keywordIDs)
+        {
+            ++offsets[keywordID + 1];
+        }
+        for (UInt32 i = 1; i <= numKeywordIDs; ++i)
+        {
+            offsets[i] += offsets[i - 1];
+        }
+        forms.resize(keywordIDs.size());
+
+        std::vector<UInt32> next(offsets.begin(), offsets.end() - 1);
+        for (UInt32 row = 0; row < NumForms(); ++row)
+        {
+            for (UInt32 i = formRows[row].offset; i < formRows[row + 1].offset; ++i)
+            {
+                forms[next[keywordIDs[i]]++] = formRows[row].formID;
+            }
+        }
+        formOffsets.swap(offsets);
+
+        blockFirst.reserve((NumForms() + kBlockSize - 1) / kBlockSize);
+        for (UInt32 row = 0; row < NumForms(); row += kBlockSize)
+        {
+            blockFirst.push_back(formRows[row].formID);
+        }
+    }
+
+    KeywordSpan GetRow(UInt32 row) const
+    {
+        return KeywordSpan(keywordIDs.data() + formRows[row].offset,
+            formRows[row + 1].offset - formRows[row].offset);
+    }
+
+    UInt32 FindRow(UInt32 formID) const
+    {
+        if (blockFirst.empty() || formID < blockFirst[0]) return kNotFound;
+
+        // Last block starting at or before formID.  Branch-free, because a
+        // mispredicted branch per step costs more than the loads.
+        const UInt32* base = blockFirst.data();
+        UInt32 n = blockFirst.size();
+        while (n > 1)
+        {
+            UInt32 half = n / 2;
+            base = base[half] <= formID ? base + half : base;
+            n -= half;
+        }
+
+        // Then count the block's rows below formID
+        UInt32 lo = (base - blockFirst.data()) * kBlockSize;
+        UInt32 hi = std::min(lo + kBlockSize, NumForms());
+        UInt32 row = lo;
+        for (UInt32 i = lo; i < hi; ++i)
+        {
+            row += formRows[i].formID < formID;
+        }
+
+        return row < hi && formRows[row].formID == formID ? row : kNotFound;
+    }
+
+    // Forward: form formRows[i].formID has keywordIDs[formRows[i].offset ..
+    // formRows[i + 1].offset).  The last row is a sentinel holding the end.
+    std::vector<Row>    formRows;
+    std::vector<UInt32> keywordIDs;
+
+    // Reverse: keyword k's forms are forms[formOffsets[k] .. formOffsets[k + 1])
+    std::vector<UInt32> formOffsets;
+    std::vector<UInt32> forms;
+
+    // First form ID of every kBlockSize rows.  Small enough to stay in
+    // cache, so a lookup misses on one line of rows rather than on every
+    // step of a binary search over all of them.
+    std::vector<UInt32> blockFirst;
+};
@@ -0,0 +1,333 @@
+#include "INICache.h"
+#include "ByteStream.h"
+#include "hash.hpp"
+
+#include "obse/GameData.h"
+
+#include <fstream>
+
+// ============================================================
+//  File layout (all integers LEB128 varints)
+//
+//  magic 'KWIC', version, load order hash, the resolved table as
+//  a string (empty if there is none), file count, then per file:
+//      path, size, write time, content hash, line count
+//      per line:  line number, token, error, form ID,
+//                 keyword count, keywords...
+//
+//  Resolved table: keyword count, keywords, file count, then per
+//  file:
+//      path, size, write time, forms, keywords, error line
+//      count, per error line: line number, error
+//      pair count, per pair: form ID minus the previous pair's
+//      (0 within a form), keyword index
+// ============================================================
+
+static const UInt32 kCacheMagic = 'KWIC';
+static const UInt32 kCacheVersion = 2;
+
+static void WriteTable(const INIResolvedTable& table, ByteWriter& out)
+{
+    out.WriteVarint(table.keywords.size());
+    for (std::string_view keyword : table.keywords)
+    {
+        out.WriteString(keyword);
+    }
+
+    out.WriteVarint(table.files.size());
+    for (const auto& file : table.files)
+    {
+        out.WriteString(file.result.filePath);
+        out.WriteVarint64(file.size);
+        out.WriteVarint64(file.writeTime);
+        out.WriteVarint(file.result.formsProcessed);
+        out.WriteVarint(file.result.keywordsAdded);
+
+        out.WriteVarint(file.errorLines.size());
+        for (const auto& line : file.errorLines)
+        {
+            out.WriteVarint(line.lineNum);
+            out.WriteString(line.error);
+        }
+
+        out.WriteVarint(file.pairs.size());
+        UInt32 prevFormID = 0;
+        for (UInt64 pair : file.pairs)
+        {
+            UInt32 formID = static_cast<UInt32>(pair >> 32);
+            out.WriteVarint(formID - prevFormID);
+            out.WriteVarint(static_cast<UInt32>(pair));
+            prevFormID = formID;
+        }
+    }
+}
+
+bool INICache::Load(const std::string& path, UInt64 loadOrderHash)
+{
+    buffer.clear();
+    table = std::string_view();
+    parsedFiles = std::string_view();
+    entries.clear();
+    formIDsValid = false;
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+
+    std::streamoff size = file.tellg();
+    if (size <= 0 || size > 0x7FFFFFFF) return false;
+    buffer.resize(static_cast<std::size_t>(size));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer.data()), size);
+    if (file.gcount() != size) return false;
+
+    ByteReader in(buffer.data(), buffer.size());
+    if (in.ReadVarint() != kCacheMagic || in.ReadVarint() != kCacheVersion) return false;
+
+    bool keepFormIDs = in.ReadVarint64() == loadOrderHash;
+    std::string_view encodedTable = in.ReadString();
+    if (!in.Ok())
+    {
+        _WARNING("INICache: '%s' is corrupt, ignoring it", path.c_str());
+        buffer.clear();
+        return false;
+    }
+
+    // The rest is decoded only if the table cannot be used
+    table = encodedTable;
+    parsedFiles = std::string_view(reinterpret_cast<const char*>(buffer.data()) + (buffer.size() - in.Remaining()),
+        in.Remaining());
+    formIDsValid = keepFormIDs;
+    return true;
+}
+
+bool INICache::TakeTable(const std::vector<std::string>& paths, const std::vector<UInt64>& sizes,
+    const std::vector<UInt64>& writeTimes, INIResolvedTable& outTable) const
+{
+    outTable = INIResolvedTable();
+    if (!formIDsValid || table.empty()) return false;
+
+    ByteReader in(reinterpret_cast<const UInt8*>(table.data()), table.size());
+
+    UInt32 numKeywords = in.ReadVarint();
+    if (numKeywords > in.Remaining()) numKeywords = in.Fail();
+    outTable.keywords.reserve(numKeywords);
+    for (UInt32 k = 0; k < numKeywords && in.Ok(); ++k)
+    {
+        std::string_view keyword = in.ReadString();
+        if (keyword.empty()) in.Fail();
+        outTable.keywords.push_back(keyword);
+    }
+
+    UInt32 numFiles = in.ReadVarint();
+    if (!in.Ok() || numFiles != paths.size())
+    {
+        outTable = INIResolvedTable();
+        return false;
+    }
+
+    outTable.files.resize(numFiles);
+    for (UInt32 f = 0; f < numFiles && in.Ok(); ++f)
+    {
+        INIResolvedFile& file = outTable.files[f];
+        file.result.filePath = in.ReadString();
+        file.size = in.ReadVarint64();
+        file.writeTime = in.ReadVarint64();
+        if (file.result.filePath != paths[f] || file.size != sizes[f] || file.writeTime != writeTimes[f])
+        {
+            outTable = INIResolvedTable();
+            return false;
+        }
+        file.result.formsProcessed = in.ReadVarint();
+        file.result.keywordsAdded = in.ReadVarint();
+
+        // Every error line takes at least 2 bytes and every pair 2 bytes,
+        // which bounds a corrupt count
+        UInt32 numErrors = in.ReadVarint();
+        if (numErrors > in.Remaining() / 2) numErrors = in.Fail();
+        file.errorLines.resize(numErrors);
+        for (auto& line : file.errorLines)
+        {
+            line.lineNum = in.ReadVarint();
+            line.error = in.ReadString();
+        }
+        file.result.errorLines = numErrors;
+
+        UInt32 numPairs = in.ReadVarint();
+        if (numPairs > in.Remaining() / 2) numPairs = in.Fail();
+        file.pairs.reserve(numPairs);
+        UInt32 formID = 0;
+        for (UInt32 i = 0; i < numPairs && in.Ok(); ++i)
+        {
+            formID += in.ReadVarint();
+            UInt32 keyword = in.ReadVarint();
+            UInt64 pair = (static_cast<UInt64>(formID) << 32) | keyword;
+            if (!formID || keyword >= numKeywords || (!file.pairs.empty() && pair <= file.pairs.back()))
+            {
+                in.Fail();
+                break;
+            }
+            file.pairs.push_back(pair);
+        }
+    }
+
+    if (!in.Ok() || !in.AtEnd())
+    {
+        _WARNING("INICache: resolved table is corrupt, ignoring it");
+        outTable = INIResolvedTable();
+        return false;
+    }
+    return true;
+}
+
+bool INICache::LoadFiles()
+{
+    entries.clear();
+
+    ByteReader in(reinterpret_cast<const UInt8*>(parsedFiles.data()), parsedFiles.size());
+    UInt32 numFiles = in.ReadVarint();
+
+    std::unordered_map<std::string, INIParsedFile> loaded;
+    for (UInt32 f = 0; f < numFiles && in.Ok(); ++f)
+    {
+        INIParsedFile parsed;
+        parsed.path = in.ReadString();
+        parsed.opened = true;
+        parsed.size = in.ReadVarint64();
+        parsed.writeTime = in.ReadVarint64();
+        parsed.contentHash = in.ReadVarint64();
+
+        // Every line takes at least 5 bytes, which bounds a corrupt count
+        UInt32 numLines = in.ReadVarint();
+        if (numLines > in.Remaining() / 5) numLines = in.Fail();
+        parsed.lines.reserve(numLines);
+        parsed.formIDs.reserve(numLines);
+
+        for (UInt32 i = 0; i < numLines && in.Ok(); ++i)
+        {
+            INIParsedLine line;
+            line.lineNum = in.ReadVarint();
+            line.token = in.ReadString();
+            line.error = in.ReadString();
+            parsed.formIDs.push_back(in.ReadVarint());
+
+            line.firstKeyword = parsed.keywords.size();
+            line.numKeywords = in.ReadVarint();
+            if (line.numKeywords > in.Remaining()) in.Fail();
+            for (UInt32 k = 0; k < line.numKeywords && in.Ok(); ++k)
+            {
+                parsed.keywords.push_back(in.ReadString());
+            }
+            parsed.lines.push_back(std::move(line));
+        }
+
+        if (!formIDsValid) parsed.formIDs.clear();
+        std::string key = parsed.path;
+        loaded[key] = std::move(parsed);
+    }
+
+    if (!in.Ok() || !in.AtEnd())
+    {
+        _WARNING("INICache: parsed files are corrupt, ignoring them");
+        return false;
+    }
+
+    entries.swap(loaded);
+    return true;
+}
+
+bool INICache::Take(const std::string& path, UInt64 size, UInt64 writeTime, INIParsedFile& outFile)
+{
+    auto it = entries.find(path);
+    if (it == entries.end() || it->second.size != size || it->second.writeTime != writeTime)
+    {
+        return false;
+    }
+
+    outFile = std::move(it->second);
+    entries.erase(it);
+    return true;
+}
+
+const std::vector<UInt32>* INICache::FindFormIDs(const std::string& path, UInt64 contentHash) const
+{
+    auto it = entries.find(path);
+    if (it == entries.end() || it->second.contentHash != contentHash || it->second.formIDs.empty())
+    {
+        return nullptr;
+    }
+    return &it->second.formIDs;
+}
+
+bool INICache::Save(const std::string& path, UInt64 loadOrderHash, const std::vector<INIParsedFile>& files,
+    const INIResolvedTable* table)
+{
+    ByteWriter out;
+    out.WriteVarint(kCacheMagic);
+    out.WriteVarint(kCacheVersion);
+    out.WriteVarint64(loadOrderHash);
+
+    ByteWriter encodedTable;
+    if (table) WriteTable(*table, encodedTable);
+    out.WriteString(std::string_view(reinterpret_cast<const char*>(encodedTable.Data()), encodedTable.Size()));
+
+    UInt32 numFiles = 0;
+    for (const auto& file : files)
+    {
+        numFiles += file.opened;
+    }
+    out.WriteVarint(numFiles);
+
+    for (const auto& file : files)
+    {
+        if (!file.opened) continue;
+
+        out.WriteString(file.path);
+        out.WriteVarint64(file.size);
+        out.WriteVarint64(file.writeTime);
+        out.WriteVarint64(file.contentHash);
+
+        out.WriteVarint(file.lines.size());
+        for (std::size_t i = 0; i < file.lines.size(); ++i)
+        {
+            const INIParsedLine& line = file.lines[i];
+            out.WriteVarint(line.lineNum);
+            out.WriteString(line.token);
+            out.WriteString(line.error);
+            out.WriteVarint(i < file.formIDs.size() ? file.formIDs[i] : 0);
+            out.WriteVarint(line.numKeywords);
+            for (UInt32 k = 0; k < line.numKeywords; ++k)
+            {
+                out.WriteString(file.keywords[line.firstKeyword + k]);
+            }
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        _WARNING("INICache: cannot write '%s'", path.c_str());
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(out.Data()), out.Size());
+    return file.good();
+}
+
+UInt64 INICache::GetLoadOrderHash()
+{
+    DataHandler* dataHandler = *g_dataHandler;
+    if (!dataHandler) return 0;
+
+    std::string modList;
+    for (UInt32 i = 0; i < dataHandler->GetActiveModCount(); ++i)
+    {
+        const char* name = dataHandler->GetNthModName(i);
+        modList += name ? name : "";
+        modList += '\n';
+    }
+    return clib_util::hash::fnv1a_64(modList);
+}
+
+UInt64 INICache::HashText(const std::vector<char>& text)
+{
+    return clib_util::hash::fnv1a_64(text);
+}
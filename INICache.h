@@ -0,0 +1,104 @@
+#pragma once
+
+#include "INIParser.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================
+//  Compiled INI cache
+//
+//  INICache.bin, next to the INI files, holds the parse stage
+//  output of every INI file from the last load plus the form ID
+//  each line resolved to.  Each file is keyed by its size and
+//  last write time, which FindFirstFileA already reports, so an
+//  unchanged file is neither read nor parsed.  A file whose
+//  stamp changed is parsed again, but if its content hash still
+//  matches (e.g. it was only touched) the cached form IDs are
+//  kept.
+//
+//  Form IDs depend on the load order, so the cache also stores a
+//  hash of the active mod list and drops every cached form ID
+//  when it differs.  Lines that failed to resolve are cached as
+//  0 and resolved again in the next session.
+//
+//  When every line resolved, the cache also holds the resolved
+//  table: each file's (form ID, keyword) pairs as applied.  If no
+//  file and not the load order changed since, LoadAll applies it
+//  as is, without decoding, interning or resolving any line, and
+//  the INI layer is frozen straight from the pairs.
+//
+//  The cache is only an accelerator: a missing, truncated or
+//  outdated file is ignored and rewritten.
+// ============================================================
+
+// The keywords one INI file added in a load, as sorted (formID << 32 |
+// keyword) pairs.  Keyword IDs only hold for one session, so in the cache
+// the low half indexes INIResolvedTable::keywords instead.
+struct INIResolvedFile
+{
+    INILoadResult              result;
+    UInt64                     size = 0;
+    UInt64                     writeTime = 0;
+    std::vector<INIParsedLine> errorLines;  // lineNum and error only
+    std::vector<UInt64>        pairs;
+};
+
+struct INIResolvedTable
+{
+    std::vector<std::string_view> keywords;     // in ascending keyword ID order when saved
+    std::vector<INIResolvedFile>  files;        // in directory order
+};
+
+class INICache
+{
+public:
+    // Reads path and checks its header.  Returns false, leaving the cache
+    // empty, if the file is missing or unreadable.  Cached form IDs are
+    // dropped unless the file was written under loadOrderHash.
+    bool Load(const std::string& path, UInt64 loadOrderHash);
+
+    // Decodes the resolved table into outTable if the cache has one and
+    // the listed files, in order, are exactly the ones it was written
+    // from, with the same size and write time, under the same load order.
+    // outTable's views point into this cache, so it must outlive them.
+    bool TakeTable(const std::vector<std::string>& paths, const std::vector<UInt64>& sizes,
+        const std::vector<UInt64>& writeTimes, INIResolvedTable& outTable) const;
+
+    // Decodes the parsed files, for Take and FindFormIDs.  Returns false,
+    // leaving them empty, if that part of the cache is corrupt.
+    bool LoadFiles();
+
+    // Moves the cached parse of path into outFile if its size and write
+    // time match.  The file's views point into this cache, so it must
+    // outlive outFile.
+    bool Take(const std::string& path, UInt64 size, UInt64 writeTime, INIParsedFile& outFile);
+
+    // Cached form IDs of path if its content hash matches, else nullptr
+    const std::vector<UInt32>* FindFormIDs(const std::string& path, UInt64 contentHash) const;
+
+    UInt32 NumFiles() const { return entries.size(); }
+
+    // False if the cache was written under another load order
+    bool FormIDsValid() const { return formIDsValid; }
+
+    bool HasTable() const { return !table.empty(); }
+
+    // Writes files, in order, with their stamps and resolved form IDs, and
+    // table if given
+    static bool Save(const std::string& path, UInt64 loadOrderHash, const std::vector<INIParsedFile>& files,
+        const INIResolvedTable* table);
+
+    // Hash of the active mod names in load order
+    static UInt64 GetLoadOrderHash();
+
+    // Hash of a file's text, stored in INIParsedFile::contentHash
+    static UInt64 HashText(const std::vector<char>& text);
+
+private:
+    std::vector<UInt8> buffer;      // the file as read; cached views point into it
+    std::string_view   table;       // the encoded resolved table, if any
+    std::string_view   parsedFiles; // the encoded parsed files
+    std::unordered_map<std::string, INIParsedFile> entries;
+    bool formIDsValid = false;
+};
@@ -1,5 +1,7 @@
 #include "INIParser.h"
+#include "INICache.h"
 #include "Keywords.h"
+#include "KeywordChanges.h"
 #include "EditorIDMapper/EditorIDMapperAPI.h"
 
 #include "string.hpp"
@@ -9,9 +11,14 @@
 #include "obse/GameData.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
 #include <fstream>
-#include <sstream>
+#include <map>
+#include <set>
+#include <thread>
+#include <unordered_map>
 #include <Windows.h>
 #include <ranges>
 
@@ -19,41 +26,101 @@
 //  Helpers
 // ============================================================
 
-void INILoader::Trim(std::string& s)
+// All parsing works on views into the file's text, so no line, token or
+// keyword is copied before it reaches the keyword table.
+
+static bool IsSpace(char c)
 {
-    // Leading
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char c) {
-        return !std::isspace(c);
-        }));
-    // Trailing
-    s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char c) {
-        return !std::isspace(c);
-        }).base(), s.end());
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+std::string_view INILoader::Trim(std::string_view s)
+{
+    while (!s.empty() && IsSpace(s.front())) s.remove_prefix(1);
+    while (!s.empty() && IsSpace(s.back()))  s.remove_suffix(1);
+    return s;
 }
 
 // Strip an inline comment (everything from the first ; or # onwards).
-static void StripComment(std::string& s)
+static std::string_view StripComment(std::string_view s)
 {
-    for (std::size_t i = 0; i < s.size(); ++i)
+    return s.substr(0, s.find_first_of(";#"));
+}
+
+// ============================================================
+//  Form resolution
+// ============================================================
+
+namespace
+{
+    struct TokenHash
     {
-        if (s[i] == ';' || s[i] == '#')
+        using is_transparent = void;
+
+        size_t operator()(std::string_view token) const
         {
-            s.erase(i);
-            return;
+            return std::hash<std::string_view>()(token);
         }
+    };
+
+    // Session caches, valid for the load order hashed in s_resolveLoadOrder.
+    // A token that fails to resolve is cached as 0.
+    std::unordered_map<std::string, UInt32, TokenHash, std::equal_to<>> s_resolvedTokens;
+    std::unordered_map<std::string, UInt8, TokenHash, std::equal_to<>>  s_modIndices;
+    UInt64 s_resolveLoadOrder = 0;
+
+    // Editor IDs that could not be looked up because EditorIDMapper was not
+    // ready, since the last LoadAll
+    std::set<std::string, std::less<>> s_unreadyMisses;
+}
+
+void INILoader::ValidateResolveCache()
+{
+    UInt64 loadOrderHash = INICache::GetLoadOrderHash();
+    if (loadOrderHash != s_resolveLoadOrder)
+    {
+        s_resolvedTokens.clear();
+        s_modIndices.clear();
+        s_resolveLoadOrder = loadOrderHash;
     }
 }
 
-// ============================================================
-//  Form resolution
-// ============================================================
+UInt32 INILoader::GetUnreadyMisses()
+{
+    return s_unreadyMisses.size();
+}
+
+UInt8 INILoader::GetModIndex(const std::string& modName)
+{
+    auto it = s_modIndices.find(modName);
+    if (it == s_modIndices.end())
+    {
+        it = s_modIndices.emplace(modName, (*g_dataHandler)->GetModIndex(modName.c_str())).first;
+    }
+    return it->second;
+}
+
+UInt32 INILoader::ResolveToken(std::string_view token)
+{
+    auto it = s_resolvedTokens.find(token);
+    if (it != s_resolvedTokens.end()) return it->second;
+
+    UInt32 formID = ResolveForm(std::string(token));
+
+    // A miss before the mapper is ready may resolve later, so is not kept
+    if (formID != 0 || EditorIDMapper::IsReady())
+    {
+        s_resolvedTokens.emplace(std::string(token), formID);
+    }
+    return formID;
+}
 
 UInt32 INILoader::ResolveForm(const std::string& token)
 {
     if (token.empty()) return 0;
 
     constexpr auto lookup_formID = [](std::uint32_t a_refID, const std::string& modName) -> std::uint32_t {
-        const auto modIdx = (*g_dataHandler)->GetModIndex(modName.c_str());
+        const auto modIdx = GetModIndex(modName);
         return modIdx == 0xFF ? 0 : (a_refID & 0xFFFFFF) | modIdx << 24;
         };
 
@@ -73,7 +140,10 @@ UInt32 INILoader::ResolveForm(const std::string& token)
 
     if (!EditorIDMapper::IsReady())
     {
-        _WARNING("INILoader: EditorIDMapper not ready, cannot resolve '%s'", token.c_str());
+        if (s_unreadyMisses.insert(token).second)
+        {
+            _WARNING("INILoader: EditorIDMapper not ready, cannot resolve '%s'", token.c_str());
+        }
         return 0;
     }
 
@@ -90,53 +160,48 @@ UInt32 INILoader::ResolveForm(const std::string& token)
 //  Line parser
 // ============================================================
 
-bool INILoader::ParseLine(const std::string& rawLine,
-    std::string& outToken,
-    std::vector<std::string>& outKeywords)
+bool INILoader::ParseLine(std::string_view rawLine,
+    std::string_view& outToken,
+    std::vector<std::string_view>& outKeywords,
+    std::string& outError)
 {
-    outToken.clear();
-    outKeywords.clear();
-
-    std::string line = rawLine;
-    StripComment(line);
-    Trim(line);
+    std::string_view line = Trim(StripComment(rawLine));
 
     if (line.empty())            return false;   // blank / comment-only
     if (line.front() == '[')     return false;   // section header  skip
 
     // Expect exactly one '=' separator
     auto eq = line.find('=');
-    if (eq == std::string::npos)
+    if (eq == std::string_view::npos)
     {
-        _WARNING("INILoader: no '=' found in line: '%s'", rawLine.c_str());
+        outError = "no '=' found in line: '" + std::string(rawLine) + "'";
         return false;
     }
 
-    outToken = line.substr(0, eq);
-    Trim(outToken);
+    outToken = Trim(line.substr(0, eq));
     if (outToken.empty())
     {
-        _WARNING("INILoader: empty form token in line: '%s'", rawLine.c_str());
+        outError = "empty form token in line: '" + std::string(rawLine) + "'";
         return false;
     }
 
-    std::string keywordPart = line.substr(eq + 1);
-
     // Split keyword list on commas
-    std::stringstream ss(keywordPart);
-    std::string kw;
-    while (std::getline(ss, kw, ','))
+    std::size_t numKeywords = outKeywords.size();
+    std::string_view keywordPart = line.substr(eq + 1);
+    while (!keywordPart.empty())
     {
-        Trim(kw);
+        std::size_t comma = keywordPart.find(',');
+        std::string_view kw = Trim(keywordPart.substr(0, comma));
         if (!kw.empty())
         {
             outKeywords.push_back(kw);
         }
+        keywordPart = comma == std::string_view::npos ? std::string_view() : keywordPart.substr(comma + 1);
     }
 
-    if (outKeywords.empty())
+    if (outKeywords.size() == numKeywords)
     {
-        _WARNING("INILoader: no keywords found in line: '%s'", rawLine.c_str());
+        outError = "no keywords found in line: '" + std::string(rawLine) + "'";
         return false;
     }
 
@@ -153,83 +218,377 @@ std::string INILoader::GetINIDirectory()
     return "Data\\OBSE\\Plugins\\OBSEKeywords\\";
 }
 
+std::string INILoader::GetCachePath()
+{
+    // Not *.ini, so LoadAll never picks it up as a keyword file
+    return GetINIDirectory() + "INICache.bin";
+}
+
 // ============================================================
-//  Load a single file
+//  Parse stage
 // ============================================================
 
-INILoadResult INILoader::LoadFile(const std::string& path)
+INIParsedFile INILoader::ParseFile(const std::string& path)
 {
-    INILoadResult result;
-    result.filePath = path;
+    INIParsedFile parsed;
+    parsed.path = path;
 
-    std::ifstream file(path);
-    if (!file.is_open())
+    // One bulk read; tokens and keywords are views into this buffer
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return parsed;
+    parsed.opened = true;
+
+    std::streamoff size = file.tellg();
+    if (size > 0)
     {
-        _WARNING("INILoader: cannot open file '%s'", path.c_str());
-        return result;
+        parsed.text.resize(static_cast<std::size_t>(size));
+        file.seekg(0);
+        file.read(parsed.text.data(), size);
+        parsed.text.resize(static_cast<std::size_t>(file.gcount()));
     }
+    parsed.contentHash = INICache::HashText(parsed.text);
 
-    _MESSAGE("INILoader: reading '%s'", path.c_str());
-
-    KeywordManager* mgr = KeywordManager::GetSingleton();
-
-    std::string line;
+    std::string_view text(parsed.text.data(), parsed.text.size());
     int lineNum = 0;
 
-    while (std::getline(file, line))
+    while (!text.empty())
     {
         ++lineNum;
 
-        std::string token;
-        std::vector<std::string> keywords;
+        std::size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.remove_suffix(1);
+        }
+
+        INIParsedLine entry;
+        entry.lineNum = lineNum;
+        entry.firstKeyword = parsed.keywords.size();
+
+        // ParseLine returns false for blanks, comments, and section headers
+        // as well as genuine errors; only errors set entry.error.
+        if (ParseLine(line, entry.token, parsed.keywords, entry.error) || !entry.error.empty())
+        {
+            entry.numKeywords = parsed.keywords.size() - entry.firstKeyword;
+            parsed.lines.push_back(std::move(entry));
+        }
+    }
+
+    return parsed;
+}
+
+std::vector<INIParsedFile> INILoader::ParseFiles(const std::vector<std::string>& paths)
+{
+    std::vector<INIParsedFile> files(paths.size());
+    std::atomic<std::size_t> nextFile = 0;
+
+    // Each worker takes the next unparsed file until none are left, so a
+    // few large files do not hold up the rest
+    auto worker = [&] {
+        for (std::size_t i = nextFile++; i < paths.size(); i = nextFile++)
+        {
+            files[i] = ParseFile(paths[i]);
+        }
+        };
+
+    std::size_t numThreads = std::min<std::size_t>(paths.size(),
+        std::max(1u, std::thread::hardware_concurrency()));
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < numThreads; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();   // the calling thread parses too
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    return files;
+}
 
-        if (!ParseLine(line, token, keywords))
+// ============================================================
+//  Resolve stage
+// ============================================================
+
+void INILoader::ResolveFiles(std::vector<INIParsedFile>& files)
+{
+    // One pass over every line before any keyword is added.  Through the
+    // token cache each distinct token costs one lookup however many lines
+    // and files repeat it, and tokens resolved by earlier loads this
+    // session cost none.
+    auto start = std::chrono::steady_clock::now();
+    ValidateResolveCache();
+    std::size_t numCached = s_resolvedTokens.size();
+
+    for (auto& file : files)
+    {
+        if (file.formIDs.size() != file.lines.size())
+        {
+            file.formIDs.assign(file.lines.size(), 0);
+        }
+
+        for (std::size_t idx = 0; idx < file.lines.size(); ++idx)
         {
-            // ParseLine returns false for blanks, comments, and section headers
-            // as well as genuine errors; it already logged warnings for errors.
-            // We only count it as an error if the line had actual content.
-            std::string trimmed = line;
-            Trim(trimmed);
-            StripComment(trimmed);
-            Trim(trimmed);
-            if (!trimmed.empty() && trimmed.front() != '[')
+            if (file.formIDs[idx] == 0 && file.lines[idx].error.empty())
             {
-                ++result.errorLines;
+                file.formIDs[idx] = ResolveToken(file.lines[idx].token);
             }
+        }
+    }
+
+    double resolveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _MESSAGE("INILoader: resolved %d new token(s) in %.1f ms",
+        (int)(s_resolvedTokens.size() - numCached), resolveMs);
+}
+
+// ============================================================
+//  Apply stage
+// ============================================================
+
+namespace
+{
+    // What each file in the INI directory last put into the INI layer
+    struct AppliedFile
+    {
+        UInt64              size = 0;
+        UInt64              writeTime = 0;
+        std::vector<UInt64> pairs;      // sorted (formID << 32 | keywordID)
+    };
+
+    // Filled by LoadAll; ReloadChanged diffs against it.  Valid for the
+    // load order it was resolved under.
+    std::map<std::string, AppliedFile> s_appliedFiles;
+    UInt64 s_appliedLoadOrder = 0;
+    bool   s_haveAppliedFiles = false;
+}
+
+INILoadResult INILoader::CollectFile(INIParsedFile& file, std::vector<UInt64>& outPairs)
+{
+    outPairs.clear();
+
+    INILoadResult result;
+    result.filePath = file.path;
+
+    if (!file.opened)
+    {
+        _WARNING("INILoader: cannot open file '%s'", file.path.c_str());
+        return result;
+    }
+
+    _MESSAGE("INILoader: reading '%s'", file.path.c_str());
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+
+    if (file.formIDs.size() != file.lines.size())
+    {
+        file.formIDs.assign(file.lines.size(), 0);
+    }
+
+    for (std::size_t idx = 0; idx < file.lines.size(); ++idx)
+    {
+        const INIParsedLine& line = file.lines[idx];
+        if (!line.error.empty())
+        {
+            _WARNING("INILoader: line %d: %s", line.lineNum, line.error.c_str());
+            ++result.errorLines;
             continue;
         }
 
-        UInt32 formID = ResolveForm(token);
+        // Normally filled in by ResolveFiles already
+        UInt32& formID = file.formIDs[idx];
+        if (formID == 0)
+        {
+            formID = ResolveToken(line.token);
+        }
         if (formID == 0)
         {
             ++result.errorLines;
             continue;
         }
 
-        for (const auto& kw : keywords)
+        for (UInt32 i = 0; i < line.numKeywords; ++i)
         {
-            if (mgr->AddKeyword(formID, kw))
+            UInt32 keywordID = mgr->InternKeyword(file.keywords[line.firstKeyword + i]);
+            if (keywordID != kInvalidKeywordID)
             {
+                outPairs.push_back((static_cast<UInt64>(formID) << 32) | keywordID);
                 ++result.keywordsAdded;
             }
         }
         ++result.formsProcessed;
     }
 
+    std::sort(outPairs.begin(), outPairs.end());
+    outPairs.erase(std::unique(outPairs.begin(), outPairs.end()), outPairs.end());
+
     _MESSAGE("INILoader: '%s'  %d forms, %d keywords, %d errors",
-        path.c_str(), result.formsProcessed, result.keywordsAdded, result.errorLines);
+        file.path.c_str(), result.formsProcessed, result.keywordsAdded, result.errorLines);
+
+    return result;
+}
+
+INILoadResult INILoader::ApplyFile(INIParsedFile& file, KeywordSource source)
+{
+    std::vector<UInt64> pairs;
+    INILoadResult result = CollectFile(file, pairs);
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    for (UInt64 pair : pairs)
+    {
+        mgr->AddKeywordID(static_cast<UInt32>(pair >> 32), static_cast<UInt32>(pair), source);
+    }
+
+    // Remembered so that ReloadChanged can diff the file later
+    if (source == kSource_INI && file.opened)
+    {
+        AppliedFile& applied = s_appliedFiles[file.path];
+        applied.size = file.size;
+        applied.writeTime = file.writeTime;
+        applied.pairs.swap(pairs);
+    }
 
     return result;
 }
 
+std::vector<INILoadResult> INILoader::ApplyTable(INIResolvedTable& table)
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+
+    // Interned in the order they were saved, the keywords usually get
+    // ascending IDs again, and then the pairs are still sorted
+    std::vector<UInt32> keywordIDs;
+    keywordIDs.reserve(table.keywords.size());
+    bool ascending = true;
+    for (std::string_view keyword : table.keywords)
+    {
+        UInt32 keywordID = mgr->InternKeyword(keyword);
+        ascending = ascending && (keywordIDs.empty() || keywordID > keywordIDs.back());
+        keywordIDs.push_back(keywordID);
+    }
+
+    std::vector<INILoadResult> results;
+    std::vector<UInt64> pairs;
+    for (auto& file : table.files)
+    {
+        for (const auto& line : file.errorLines)
+        {
+            _WARNING("INILoader: line %d: %s", line.lineNum, line.error.c_str());
+        }
+        _MESSAGE("INILoader: '%s'  %d forms, %d keywords, %d errors",
+            file.result.filePath.c_str(), file.result.formsProcessed, file.result.keywordsAdded,
+            file.result.errorLines);
+
+        for (UInt64& pair : file.pairs)
+        {
+            pair = (pair & 0xFFFFFFFF00000000ull) | keywordIDs[static_cast<UInt32>(pair)];
+        }
+        if (!ascending)
+        {
+            std::sort(file.pairs.begin(), file.pairs.end());
+        }
+        pairs.insert(pairs.end(), file.pairs.begin(), file.pairs.end());
+
+        AppliedFile& applied = s_appliedFiles[file.result.filePath];
+        applied.size = file.size;
+        applied.writeTime = file.writeTime;
+        applied.pairs.swap(file.pairs);
+
+        results.push_back(std::move(file.result));
+    }
+
+    // Several files may give a form the same keyword
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    mgr->AddBaselinePairs(std::move(pairs));
+
+    return results;
+}
+
+bool INILoader::BuildTable(const std::vector<INIParsedFile>& files,
+    const std::vector<INILoadResult>& results, INIResolvedTable& outTable)
+{
+    outTable = INIResolvedTable();
+
+    for (const auto& file : files)
+    {
+        if (!file.opened) return false;
+        for (std::size_t i = 0; i < file.lines.size(); ++i)
+        {
+            if (file.lines[i].error.empty() && file.formIDs[i] == 0) return false;
+        }
+    }
+
+    // Keyword IDs only hold for this session, so the pairs are saved with
+    // an index into the table's keywords instead.  Listing the keywords in
+    // ascending ID order keeps the pairs sorted.
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    std::vector<UInt32> keywordIndices(mgr->GetNumKeywordIDs(), 0);
+    for (const auto& file : files)
+    {
+        for (UInt64 pair : s_appliedFiles[file.path].pairs)
+        {
+            keywordIndices[static_cast<UInt32>(pair)] = 1;
+        }
+    }
+    for (UInt32 keywordID = 0; keywordID < keywordIndices.size(); ++keywordID)
+    {
+        if (!keywordIndices[keywordID]) continue;
+
+        keywordIndices[keywordID] = outTable.keywords.size();
+        outTable.keywords.push_back(mgr->GetKeywordName(keywordID));
+    }
+
+    outTable.files.resize(files.size());
+    for (std::size_t f = 0; f < files.size(); ++f)
+    {
+        const INIParsedFile& file = files[f];
+        INIResolvedFile& resolved = outTable.files[f];
+        resolved.result = results[f];
+        resolved.size = file.size;
+        resolved.writeTime = file.writeTime;
+
+        for (const auto& line : file.lines)
+        {
+            if (line.error.empty()) continue;
+
+            INIParsedLine& errorLine = resolved.errorLines.emplace_back();
+            errorLine.lineNum = line.lineNum;
+            errorLine.error = line.error;
+        }
+
+        const std::vector<UInt64>& pairs = s_appliedFiles[file.path].pairs;
+        resolved.pairs.reserve(pairs.size());
+        for (UInt64 pair : pairs)
+        {
+            resolved.pairs.push_back((pair & 0xFFFFFFFF00000000ull) | keywordIndices[static_cast<UInt32>(pair)]);
+        }
+    }
+    return true;
+}
+
 // ============================================================
-//  Load all *.ini files in the plugin directory
+//  Load a single file
 // ============================================================
 
-std::vector<INILoadResult> INILoader::LoadAll()
+INILoadResult INILoader::LoadFile(const std::string& path, KeywordSource source)
 {
-    std::vector<INILoadResult> results;
+    std::vector<INIParsedFile> files;
+    files.push_back(ParseFile(path));
+    ResolveFiles(files);
+    return ApplyFile(files[0], source);
+}
+
+// ============================================================
+//  Load all *.ini files in the plugin directory
+// ============================================================
 
+void INILoader::ListFiles(std::vector<std::string>& outPaths,
+    std::vector<UInt64>& outSizes, std::vector<UInt64>& outWriteTimes)
+{
     std::string dir = GetINIDirectory();
     std::string pattern = dir + "*.ini";
 
@@ -239,7 +598,7 @@ std::vector<INILoadResult> INILoader::LoadAll()
     if (hFind == INVALID_HANDLE_VALUE)
     {
         _MESSAGE("INILoader: no *.ini files found in '%s' (or directory missing)", dir.c_str());
-        return results;
+        return;
     }
 
     do
@@ -247,15 +606,19 @@ std::vector<INILoadResult> INILoader::LoadAll()
         // Skip directories (shouldn't exist here, but be safe)
         if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
 
-        std::string fullPath = dir + findData.cFileName;
-        results.push_back(LoadFile(fullPath));
+        outPaths.push_back(dir + findData.cFileName);
+        outSizes.push_back((static_cast<UInt64>(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow);
+        outWriteTimes.push_back((static_cast<UInt64>(findData.ftLastWriteTime.dwHighDateTime) << 32)
+            | findData.ftLastWriteTime.dwLowDateTime);
 
     }
     while (FindNextFileA(hFind, &findData));
 
     FindClose(hFind);
+}
 
-    // Summary
+static void LogSummary(const std::vector<INILoadResult>& results)
+{
     int totalForms = 0, totalKeywords = 0, totalErrors = 0;
     for (const auto& r : results)
     {
@@ -265,6 +628,199 @@ std::vector<INILoadResult> INILoader::LoadAll()
     }
     _MESSAGE("INILoader: finished  %d file(s), %d forms, %d keywords, %d error line(s)",
         (int)results.size(), totalForms, totalKeywords, totalErrors);
+}
+
+std::vector<INILoadResult> INILoader::LoadAll()
+{
+    std::vector<INILoadResult> results;
+
+    UInt64 loadOrderHash = INICache::GetLoadOrderHash();
+    s_appliedFiles.clear();
+    s_appliedLoadOrder = loadOrderHash;
+    s_haveAppliedFiles = true;
+    s_unreadyMisses.clear();
+
+    std::vector<std::string> paths;
+    std::vector<UInt64> sizes, writeTimes;
+    ListFiles(paths, sizes, writeTimes);
+    if (paths.empty()) return results;
+
+    auto start = std::chrono::steady_clock::now();
+
+    INICache cache;
+    bool cacheLoaded = cache.Load(GetCachePath(), loadOrderHash);
+
+    // Nothing changed since the cache was written: apply what it resolved
+    INIResolvedTable table;
+    if (cacheLoaded && cache.TakeTable(paths, sizes, writeTimes, table))
+    {
+        results = ApplyTable(table);
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        _MESSAGE("INILoader: %d file(s) applied from the resolved cache in %.1f ms", (int)results.size(), ms);
+        LogSummary(results);
+        return results;
+    }
+
+    // Otherwise files whose size and write time match the cache are taken
+    // from it unread; the rest are parsed in parallel
+    cacheLoaded = cacheLoaded && cache.LoadFiles();
+    UInt32 numCachedFiles = cache.NumFiles();
+
+    std::vector<INIParsedFile> files(paths.size());
+    std::vector<std::string> changedPaths;
+    std::vector<std::size_t> changedIndices;
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+        if (!cache.Take(paths[i], sizes[i], writeTimes[i], files[i]))
+        {
+            changedPaths.push_back(paths[i]);
+            changedIndices.push_back(i);
+        }
+    }
+
+    std::vector<INIParsedFile> parsed = ParseFiles(changedPaths);
+    for (std::size_t i = 0; i < parsed.size(); ++i)
+    {
+        INIParsedFile& file = files[changedIndices[i]];
+        file = std::move(parsed[i]);
+        file.size = sizes[changedIndices[i]];
+        file.writeTime = writeTimes[changedIndices[i]];
+
+        // Same text under a new stamp resolves to the same forms
+        if (const std::vector<UInt32>* formIDs = cache.FindFormIDs(file.path, file.contentHash))
+        {
+            file.formIDs = *formIDs;
+        }
+    }
+
+    double parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _MESSAGE("INILoader: %d file(s) from cache, parsed %d in %.1f ms",
+        (int)(files.size() - changedPaths.size()), (int)changedPaths.size(), parseMs);
+
+    ResolveFiles(files);
+
+    // Apply in FindFirstFileA order on this thread, so the keywords and log
+    // match loading the files one after another
+    for (auto& file : files)
+    {
+        results.push_back(ApplyFile(file, kSource_INI));
+    }
+
+    // Rewrite the cache if any file changed, appeared or disappeared, or
+    // the load order did, or if the resolved table can now be cached or no
+    // longer can.  Resolved form IDs are only known after applying.
+    bool haveTable = BuildTable(files, results, table);
+    if (!cacheLoaded || !changedPaths.empty() || numCachedFiles != files.size()
+        || !cache.FormIDsValid() || haveTable != cache.HasTable())
+    {
+        INICache::Save(GetCachePath(), loadOrderHash, files, haveTable ? &table : nullptr);
+    }
+
+    LogSummary(results);
+    return results;
+}
+
+// ============================================================
+//  Reload changed files
+// ============================================================
+
+std::vector<INILoadResult> INILoader::ReloadChanged()
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+
+    // Form IDs may have moved, so every file needs resolving again
+    if (!s_haveAppliedFiles || s_appliedLoadOrder != INICache::GetLoadOrderHash())
+    {
+        std::vector<INILoadResult> results;
+        mgr->BuildBaseline([&results] { results = LoadAll(); });
+        return results;
+    }
+
+    std::vector<std::string> paths;
+    std::vector<UInt64> sizes, writeTimes;
+    ListFiles(paths, sizes, writeTimes);
+
+    std::vector<std::string> changedPaths;
+    std::vector<std::size_t> changedIndices;
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+        auto it = s_appliedFiles.find(paths[i]);
+        if (it == s_appliedFiles.end() || it->second.size != sizes[i] || it->second.writeTime != writeTimes[i])
+        {
+            changedPaths.push_back(paths[i]);
+            changedIndices.push_back(i);
+        }
+    }
+
+    std::vector<INIParsedFile> files = ParseFiles(changedPaths);
+    for (std::size_t i = 0; i < files.size(); ++i)
+    {
+        files[i].size = sizes[changedIndices[i]];
+        files[i].writeTime = writeTimes[changedIndices[i]];
+    }
+    ResolveFiles(files);
+
+    // Each changed file's old and new keywords give what it added and
+    // dropped.  Files no longer in the directory drop everything.
+    std::vector<INILoadResult> results;
+    std::vector<UInt64> added, removed, pairs;
+    for (auto& file : files)
+    {
+        results.push_back(CollectFile(file, pairs));
+
+        AppliedFile& applied = s_appliedFiles[file.path];
+        std::set_difference(pairs.begin(), pairs.end(), applied.pairs.begin(), applied.pairs.end(),
+            std::back_inserter(added));
+        std::set_difference(applied.pairs.begin(), applied.pairs.end(), pairs.begin(), pairs.end(),
+            std::back_inserter(removed));
+
+        if (file.opened)
+        {
+            applied.size = file.size;
+            applied.writeTime = file.writeTime;
+            applied.pairs.swap(pairs);
+        }
+        else
+        {
+            s_appliedFiles.erase(file.path);
+        }
+    }
+
+    std::set<std::string> listed(paths.begin(), paths.end());
+    for (auto it = s_appliedFiles.begin(); it != s_appliedFiles.end(); )
+    {
+        if (listed.count(it->first))
+        {
+            ++it;
+            continue;
+        }
+        _MESSAGE("INILoader: '%s' was removed", it->first.c_str());
+        removed.insert(removed.end(), it->second.pairs.begin(), it->second.pairs.end());
+        it = s_appliedFiles.erase(it);
+    }
+
+    std::sort(added.begin(), added.end());
+    added.erase(std::unique(added.begin(), added.end()), added.end());
+    std::sort(removed.begin(), removed.end());
+    removed.erase(std::unique(removed.begin(), removed.end()), removed.end());
+
+    // A keyword dropped from one file stays if another file still sets it
+    removed.erase(std::remove_if(removed.begin(), removed.end(), [](UInt64 pair) {
+        for (const auto& [path, applied] : s_appliedFiles)
+        {
+            if (std::binary_search(applied.pairs.begin(), applied.pairs.end(), pair)) return true;
+        }
+        return false;
+        }), removed.end());
+
+    if (!added.empty() || !removed.empty())
+    {
+        mgr->PatchBaseline(added, removed);
+    }
+
+    _MESSAGE("INILoader: reload  %d changed file(s), %d unchanged, %d keyword(s) added, %d removed",
+        (int)files.size(), (int)(paths.size() - changedPaths.size()), (int)added.size(), (int)removed.size());
 
     return results;
 }
@@ -283,7 +839,12 @@ bool Cmd_LoadKeywordsFromINI_Execute(COMMAND_ARGS)
     if (!ExtractArgs(PASS_EXTRACT_ARGS, &path)) return true;
     if (!path[0]) return true;
 
-    INILoadResult r = INILoader::LoadFile(path);
+    // Only the INI directory belongs to the INI layer, so keywords from any
+    // other file are kept in the save like other runtime changes.
+    // Subscribers get one reset rather than a change per tag.
+    KeywordChangeLog::BeginReset(KeywordAPI::kReset_INI);
+    INILoadResult r = INILoader::LoadFile(path, kSource_Runtime);
+    KeywordChangeLog::Flush();
     *result = (r.formsProcessed > 0 || r.keywordsAdded > 0)
         ? r.keywordsAdded
         : -1;
@@ -294,16 +855,19 @@ bool Cmd_LoadKeywordsFromINI_Execute(COMMAND_ARGS)
 }
 
 // ReloadKeywordINIs
-// Scans the default directory and (re-)applies all *.ini files.
-// Does NOT clear existing keywords first  use ClearAllKeywords first if you want a clean slate.
-// Returns total number of keywords added.
+// Scans the default directory and brings the INI keyword layer up to date
+// with the *.ini files: files added or edited since the last load are read
+// again and only the keywords they gained or lost are applied, and deleted
+// files take their keywords with them.  Keywords changed at runtime are
+// kept on top.  Returns the number of keywords in the files read again.
 bool Cmd_ReloadKeywordINIs_Execute(COMMAND_ARGS)
 {
     *result = 0;
 
     Console_Print("INI reload from '%s'...", INILoader::GetINIDirectory().c_str());
 
-    auto results = INILoader::LoadAll();
+    std::vector<INILoadResult> results = INILoader::ReloadChanged();
+    KeywordChangeLog::Flush();
 
     int total = 0;
     for (const auto& r : results)
@@ -313,7 +877,7 @@ bool Cmd_ReloadKeywordINIs_Execute(COMMAND_ARGS)
             r.filePath.c_str(), r.keywordsAdded, r.errorLines);
     }
 
-    Console_Print("INI reload complete: %d file(s), %d keywords total",
+    Console_Print("INI reload complete: %d changed file(s), %d keywords total",
         (int)results.size(), total);
 
     *result = total;
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <Keywords.h>
 
+struct INIResolvedTable;
+
 // ============================================================
 //  INI format reference
 //
@@ -27,6 +30,34 @@
 //  ; Blank lines are ignored.
 // ============================================================
 
+// One keyword line of an INI file, parsed but not yet resolved to a form
+struct INIParsedLine
+{
+    int              lineNum = 0;
+    std::string_view token;             // editor ID or form ID
+    UInt32           firstKeyword = 0;  // index into INIParsedFile::keywords
+    UInt32           numKeywords = 0;
+    std::string      error;             // set instead of the above for a malformed line
+};
+
+// Output of the parse stage for one file: its keyword lines and malformed
+// lines in file order (blank lines, comments and section headers dropped).
+// Tokens and keywords are views into text, which is a vector rather than a
+// string so that moving the file never moves the characters, or into the
+// INICache the file was taken from (text is then empty).
+struct INIParsedFile
+{
+    std::string                   path;
+    bool                          opened = false;
+    UInt64                        size = 0;         // from FindFirstFileA, for INICache
+    UInt64                        writeTime = 0;
+    UInt64                        contentHash = 0;
+    std::vector<char>             text;
+    std::vector<std::string_view> keywords;
+    std::vector<INIParsedLine>    lines;
+    std::vector<UInt32>           formIDs;          // per line once resolved; 0 if unresolved
+};
+
 struct INILoadResult
 {
     std::string filePath;
@@ -41,27 +72,92 @@ public:
     
     // Load all *.ini files found under
     //   Data/OBSE/Plugins/OBSEKeywords/
-    // Returns one result entry per file parsed.
+    // Returns one result entry per file parsed.  Files unchanged since the
+    // last load come from INICache.bin; the rest are parsed in parallel.
+    // All are then applied one by one in directory order.
     static std::vector<INILoadResult> LoadAll();
 
+    // Updates the INI layer from the files added, edited or deleted since
+    // LoadAll, applying only the keywords each changed file gained or lost.
+    // Falls back to rebuilding the layer with LoadAll if there was none or
+    // the load order changed.  Returns one result entry per file read.
+    static std::vector<INILoadResult> ReloadChanged();
+
     // Load a single named file (absolute or relative to working dir).
-    static INILoadResult LoadFile(const std::string& path);
+    // source decides whether the keywords are saved: the INI directory
+    // makes up the INI layer, which is built once per session and rebuilt
+    // only by ReloadKeywordINIs, so its keywords are not saved; keywords
+    // from other files are.
+    static INILoadResult LoadFile(const std::string& path, KeywordSource source);
 
     // Return the canonical directory that LoadAll() scans.
     static std::string GetINIDirectory();
 
+    // Loading runs in three stages.  The parse stage is pure string work (no
+    // game data, no logging) and safe to run on any thread; ParseFiles runs
+    // it on a worker pool and returns the files in the order given.  The
+    // resolve and apply stages need game data and must run on the main
+    // thread.  ResolveFiles fills in file.formIDs for every line that has
+    // none yet; ApplyFile resolves any lines still missing, adds the
+    // keywords and logs.
+    static INIParsedFile ParseFile(const std::string& path);
+    static std::vector<INIParsedFile> ParseFiles(const std::vector<std::string>& paths);
+    static void ResolveFiles(std::vector<INIParsedFile>& files);
+    static INILoadResult ApplyFile(INIParsedFile& file, KeywordSource source);
+
+    // Path of the compiled INI cache
+    static std::string GetCachePath();
+
+    // Number of editor IDs left unresolved since the last LoadAll because
+    // EditorIDMapper was not ready yet.  Misses like these are not cached,
+    // so running LoadAll again once the mapper is ready resolves them.
+    static UInt32 GetUnreadyMisses();
+
 private:
-    // Parse one logical line.  Returns false on bad format.
-    static bool ParseLine(const std::string& line,
-        std::string& outEditorIDOrFormID,
-        std::vector<std::string>& outKeywords);
+    // Parse one logical line.  Returns false on bad format, with the reason
+    // in outError, and for lines without content (outError left empty).
+    // Keywords are appended to outKeywords; all outputs view into line.
+    static bool ParseLine(std::string_view line,
+        std::string_view& outEditorIDOrFormID,
+        std::vector<std::string_view>& outKeywords,
+        std::string& outError);
 
     // Resolve an editorID or "0x" hex string to a form ID.
     // Returns 0 if the form cannot be found.
     static UInt32 ResolveForm(const std::string& token);
 
-    // Trim leading/trailing whitespace in-place.
-    static void Trim(std::string& s);
+    // Resolves any lines still missing a form ID, logs like ApplyFile and
+    // returns the file's keywords as sorted, unique (formID << 32 |
+    // keywordID) pairs without adding them
+    static INILoadResult CollectFile(INIParsedFile& file, std::vector<UInt64>& outPairs);
+
+    // LoadAll's fast path: interns the table's keywords once and adds
+    // every file's pairs to the INI layer in one go, logging as ApplyFile
+    static std::vector<INILoadResult> ApplyTable(INIResolvedTable& table);
+
+    // The table to cache for files just applied by LoadAll.  Returns false
+    // if a line is left unresolved, since it must be retried next session.
+    static bool BuildTable(const std::vector<INIParsedFile>& files,
+        const std::vector<INILoadResult>& results, INIResolvedTable& outTable);
+
+    // *.ini files in the INI directory, in FindFirstFileA order, with the
+    // size and last write time it reports
+    static void ListFiles(std::vector<std::string>& outPaths,
+        std::vector<UInt64>& outSizes, std::vector<UInt64>& outWriteTimes);
+
+    // ResolveForm through the session cache, which keeps misses too so a
+    // broken token is looked up and reported once per session
+    static UInt32 ResolveToken(std::string_view token);
+
+    // Cached DataHandler::GetModIndex; 0xFF if the mod is not loaded
+    static UInt8 GetModIndex(const std::string& modName);
+
+    // Clears the session caches if the load order changed since they were
+    // filled
+    static void ValidateResolveCache();
+
+    // Trim leading/trailing whitespace.
+    static std::string_view Trim(std::string_view s);
 };
 
 // Script command
@@ -21,13 +21,28 @@
 //       KeywordAPI::AddKeyword(formID, "Weapon");
 //       if (KeywordAPI::HasKeyword(formID, "Blade")) { ... }
 //
+//  The ready signal carries a table of function pointers
+//  (KeywordInterface), and once it has arrived the functions
+//  above call straight through it instead of dispatching a
+//  message per call.  Hot paths can also fetch the table with
+//  GetInterface() and use keyword handles:
+//
+//       const KeywordAPI::KeywordInterface* kw = KeywordAPI::GetInterface();
+//       UInt32 blade = kw->GetKeywordHandle("Blade");     // once
+//       if (kw->HasKeywordH(formID, blade)) { ... }       // per hit
+//
 //  REQUIREMENTS
 //  ------------
 //  OBSEKeywords.dll (or OBSEKeywords.dll) must be loaded.
 // ============================================================
 
 #include "obse/PluginAPI.h"
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
+#include <set>
+#include <string>
+#include <vector>
 
 namespace KeywordAPI
 {
@@ -42,6 +57,15 @@ namespace KeywordAPI
     static const UInt32 kMessage_GetNth = 'KWGN';
     static const UInt32 kMessage_HasAny = 'KWAN';
     static const UInt32 kMessage_HasAll = 'KWAL';
+    static const UInt32 kMessage_HasExpr = 'KWEX';
+    static const UInt32 kMessage_FindForms = 'KWFF';
+    static const UInt32 kMessage_GetInterface = 'KWIF';
+    static const UInt32 kMessage_HasBatch = 'KWBT';
+    static const UInt32 kMessage_GetKeywords = 'KWGK';
+    static const UInt32 kMessage_Subscribe = 'KWSB';
+    static const UInt32 kMessage_Unsubscribe = 'KWUS';
+    static const UInt32 kMessage_FlushChanges = 'KWFL';
+    static const UInt32 kMessage_HasKeywordList = 'KWML';
 
     // ---- Data structs ----
 
@@ -67,11 +91,232 @@ namespace KeywordAPI
         bool        result;      // out
     };
 
+    // Version 2 of the multi-keyword query, for kMessage_HasKeywordList:
+    // any number of keywords, as strings or handles, and a match mode.
+    // version and size come first in every version, and later versions
+    // only append fields, so OBSEKeywords reads the fields it knows and
+    // reports its own version in serverVersion.  serverVersion stays 0 if
+    // OBSEKeywords predates this message (HasKeywordList then falls back
+    // to kMessage_HasAny / kMessage_HasAll).
+
+    static const UInt32 kMultiKeywordDataVersion = 2;
+
+    enum MatchMode : UInt32
+    {
+        kMatch_Any,     // has at least one of the keywords (false for an empty list)
+        kMatch_All,     // has every keyword (true for an empty list)
+        kMatch_None,    // has none of the keywords
+    };
+
+    struct MultiKeywordDataV2
+    {
+        UInt32             version;         // in: kMultiKeywordDataVersion
+        UInt32             size;            // in: sizeof(MultiKeywordDataV2)
+        UInt32             formID;          // in
+        UInt32             mode;            // in: MatchMode
+        const char* const* keywords;        // in: count strings; null and empty entries are skipped
+        const UInt32*      handles;         // in, used if keywords is null; 0 entries are skipped
+        UInt32             count;           // in
+        bool               result;          // out (false for an unknown mode)
+        UInt32             serverVersion;   // out: version OBSEKeywords understood, 0 if not handled
+    };
+
+    struct ExprData
+    {
+        UInt32      formID;
+        const char* expression; // in, e.g. "Weapon & (Blade | Axe) & !Broken"
+        bool        result;     // out
+        bool        valid;      // out (false if the expression failed to parse)
+    };
+
+    struct FindFormsData
+    {
+        const char* expression; // in, e.g. "Weapon & Silver & !Unique"
+        UInt32*     formIDs;    // in: caller's buffer (may be null), out: matching form IDs
+        UInt32      capacity;   // in: size of the formIDs buffer
+        UInt32      count;      // out: total number of matches (may exceed capacity)
+        bool        valid;      // out (false if the expression failed to parse)
+    };
+
+    // Enumerates a form's keywords in one call, in the same order as
+    // GetNthKeyword.  Nothing is copied: keywords receives pointers to
+    // OBSEKeywords's interned, lowercase keyword names and handles their
+    // handles.  Pass either buffer, both or neither (to get the count).
+    //
+    // The pointers and handles stay valid at least until the next save is
+    // loaded.  Do not free or modify the strings.
+    struct GetKeywordsData
+    {
+        UInt32       formID;    // in
+        const char** keywords;  // in: caller's buffer (may be null), out: keyword names
+        UInt32*      handles;   // in: caller's buffer (may be null), out: keyword handles
+        UInt32       capacity;  // in: size of each buffer given
+        UInt32       count;     // out: number of keywords on the form (may exceed capacity)
+    };
+
+    // Tests numForms forms against numKeywords keywords in one call.  Each
+    // keyword is looked up once for the whole batch.  Keywords are given as
+    // strings, or as handles (see KeywordInterface) when keywords is null.
+    // Fill in results, masks or both.
+    struct BatchData
+    {
+        const UInt32*      formIDs;     // in
+        UInt32             numForms;    // in
+        const char* const* keywords;    // in (null entries match nothing)
+        const UInt32*      handles;     // in, used if keywords is null
+        UInt32             numKeywords; // in
+        UInt8*             results;     // out, optional: numForms x numKeywords, one row per
+                                        //   form, 1 if it has the keyword, else 0
+        UInt64*            masks;       // out, optional: numForms x ((numKeywords + 63) / 64)
+                                        //   words per form, bit k set if it has keyword k
+        bool               handled;     // out: false if OBSEKeywords is too old for batches,
+                                        //   or formIDs, or both keywords and handles, are
+                                        //   null with a nonzero count
+    };
+
+    // ---- Change notifications ----
+    //
+    // A subscriber's callback receives the keyword changes made since the
+    // last flush as one batch.  Changes are coalesced per (form, keyword):
+    // adding and then removing a keyword before the flush reports nothing,
+    // and each pair appears at most once with its net effect.
+    //
+    // Batches are delivered at flush points.  OBSE has no per-frame message,
+    // so a subscriber that wants a batch per frame calls FlushChanges from
+    // its own frame hook; any subscriber's flush delivers to all of them.
+    // OBSEKeywords also flushes after loading a save, starting a new game
+    // and the LoadKeywordsFromINI / ReloadKeywordINIs commands.
+    //
+    // Those bulk operations do not report individual changes.  The batch
+    // instead has resetReasons set and no changes: re-read every form you
+    // mirror.  Changes made from inside a callback go into the next batch.
+
+    static const UInt32 kReset_INI = 1 << 0;    // INI files loaded or reloaded
+    static const UInt32 kReset_Game = 1 << 1;   // save loaded or new game started
+
+    struct KeywordChange
+    {
+        UInt32 formID;
+        UInt32 handle;      // keyword handle (see KeywordInterface)
+        bool   added;       // true if the form gained the keyword, false if it lost it
+    };
+
+    struct ChangeBatch
+    {
+        UInt32               resetReasons;  // kReset_* flags; nonzero means re-read everything
+        const KeywordChange* changes;       // sorted by form ID, then handle
+        UInt32               numChanges;
+    };
+
+    typedef void (*ChangeCallback)(const ChangeBatch* batch, void* context);
+
+    // Both filters are optional.  With a form filter only changes to those
+    // forms are delivered, with a keyword filter only changes of those
+    // keywords, and with both only changes matching both.  Batches that
+    // end up empty are not delivered; resets always are.
+    struct SubscribeData
+    {
+        ChangeCallback callback;        // in
+        void*          context;         // in, passed back to callback
+        const UInt32*  formIDs;         // in, optional filter
+        UInt32         numForms;        // in
+        const UInt32*  handles;         // in, optional filter
+        UInt32         numHandles;      // in
+        UInt32         subscriptionID;  // out: 0 if OBSEKeywords is too old or callback is null
+    };
+
+    struct UnsubscribeData
+    {
+        UInt32 subscriptionID;  // in
+        bool   result;          // out: false if there was no such subscription
+    };
+
+    // ---- Direct interface ----
+    //
+    // Filled in by OBSEKeywords and valid for the rest of the session.
+    // Fields are only ever appended: check version (or size) before using
+    // fields added after version 1.
+    //
+    // Handles are interned keyword IDs; 0 is never a valid handle and
+    // matches nothing.  They stay valid for the whole session, but not
+    // across sessions, so do not save them.  (The GetKeywordHandle script
+    // command returns a different, name-derived handle that scripts can
+    // keep in a save.)
+
+    static const UInt32 kInterfaceVersion = 5;
+
+    struct KeywordInterface
+    {
+        UInt32 version;     // kInterfaceVersion of the OBSEKeywords build
+        UInt32 size;        // sizeof(KeywordInterface) in that build
+
+        // By keyword string (case-insensitive)
+        bool   (*AddKeyword)(UInt32 formID, const char* keyword);
+        bool   (*RemoveKeyword)(UInt32 formID, const char* keyword);
+        bool   (*HasKeyword)(UInt32 formID, const char* keyword);
+        UInt32 (*GetKeywordCount)(UInt32 formID);
+        void   (*ClearKeywords)(UInt32 formID);
+        bool   (*HasKeywordExpr)(UInt32 formID, const char* expression);
+
+        // Handles.  GetKeywordHandle interns the keyword (0 for an empty
+        // string); GetKeywordName returns its lowercase text, or "" for an
+        // unknown handle.
+        UInt32      (*GetKeywordHandle)(const char* keyword);
+        const char* (*GetKeywordName)(UInt32 handle);
+        bool   (*AddKeywordH)(UInt32 formID, UInt32 handle);
+        bool   (*RemoveKeywordH)(UInt32 formID, UInt32 handle);
+        bool   (*HasKeywordH)(UInt32 formID, UInt32 handle);
+        bool   (*HasAnyKeywordH)(UInt32 formID, const UInt32* handles, UInt32 count);
+        bool   (*HasAllKeywordsH)(UInt32 formID, const UInt32* handles, UInt32 count);
+
+        // Writes up to capacity of the form's keyword handles, in ascending
+        // order, and returns how many it has
+        UInt32 (*GetKeywordHandles)(UInt32 formID, UInt32* outHandles, UInt32 capacity);
+
+        // Version 2
+        void   (*HasKeywordsBatch)(BatchData* batch);
+
+        // Version 3.  As GetKeywordHandles, but writes pointers to the
+        // keyword names (see GetKeywordsData for their lifetime)
+        UInt32 (*GetKeywordNames)(UInt32 formID, const char** outKeywords, UInt32 capacity);
+
+        // Version 4.  Change notifications; Subscribe copies the filters and
+        // returns the subscription ID (also written to data->subscriptionID)
+        UInt32 (*Subscribe)(SubscribeData* data);
+        bool   (*Unsubscribe)(UInt32 subscriptionID);
+        void   (*FlushChanges)();
+
+        // Version 5.  As kMessage_HasKeywordList; returns data->result
+        bool   (*HasKeywordList)(MultiKeywordDataV2* data);
+    };
+
+    struct GetInterfaceData
+    {
+        const KeywordInterface* intfc;  // out (null if OBSEKeywords is too old)
+    };
+
     // ---- Client state ----
 
     inline bool                       s_ready = false;
     inline OBSEMessagingInterface* s_msgIntfc = nullptr;
     inline PluginHandle               s_pluginHandle = kPluginHandle_Invalid;
+    inline const KeywordInterface*    s_interface = nullptr;
+
+    // Names copied by GetKeywords from an OBSEKeywords without
+    // kMessage_GetKeywords, one per keyword, so the pointers it returns
+    // stay valid
+    inline std::set<std::string, std::less<>> s_keywordNameCopies;
+
+    // A table too small to hold every version 1 field is ignored, leaving
+    // the functions on messages
+    inline void SetInterface(const KeywordInterface* intfc)
+    {
+        if (intfc && intfc->version >= 1
+            && intfc->size >= offsetof(KeywordInterface, GetKeywordHandles) + sizeof(void*))
+        {
+            s_interface = intfc;
+        }
+    }
 
     // ---- MessageHandler ----
 
@@ -81,6 +326,12 @@ namespace KeywordAPI
         {
             s_ready = true;
             _MESSAGE("OBSEKeywords: received ready signal");
+
+            // Older builds send no data with the signal
+            if (msg->data && msg->dataLen >= sizeof(UInt32) * 2)
+            {
+                SetInterface(static_cast<const KeywordInterface*>(msg->data));
+            }
         }
     }
 
@@ -111,10 +362,29 @@ namespace KeywordAPI
         return s_ready && s_msgIntfc != nullptr;
     }
 
+    // ---- GetInterface ----
+    // The direct interface, or null if OBSEKeywords is not loaded or too
+    // old to provide one.  Asks for it if the ready signal did not carry it.
+
+    inline const KeywordInterface* GetInterface()
+    {
+        if (!s_interface && s_msgIntfc)
+        {
+            GetInterfaceData data = { nullptr };
+            s_msgIntfc->Dispatch(s_pluginHandle, kMessage_GetInterface,
+                &data, sizeof(data), nullptr);
+            SetInterface(data.intfc);
+        }
+        return s_interface;
+    }
+
     // ---- AddKeyword ----
 
     inline bool AddKeyword(UInt32 formID, const char* keyword)
     {
+        if (!IsReady() || !keyword) return false;
+        if (s_interface) return s_interface->AddKeyword(formID, keyword);
+
         BasicData data = { formID, keyword, false, 0 };
         s_msgIntfc->Dispatch(s_pluginHandle, kMessage_AddKeyword,
             &data, sizeof(data), nullptr);
@@ -126,6 +396,7 @@ namespace KeywordAPI
     inline bool RemoveKeyword(UInt32 formID, const char* keyword)
     {
         if (!IsReady() || !keyword) return false;
+        if (s_interface) return s_interface->RemoveKeyword(formID, keyword);
 
         BasicData data = { formID, keyword, false, 0 };
         s_msgIntfc->Dispatch(s_pluginHandle, kMessage_RemoveKeyword,
@@ -138,6 +409,7 @@ namespace KeywordAPI
     inline bool HasKeyword(UInt32 formID, const char* keyword)
     {
         if (!IsReady() || !keyword) return false;
+        if (s_interface) return s_interface->HasKeyword(formID, keyword);
 
         BasicData data = { formID, keyword, false, 0 };
         s_msgIntfc->Dispatch(s_pluginHandle, kMessage_HasKeyword,
@@ -150,6 +422,7 @@ namespace KeywordAPI
     inline UInt32 GetKeywordCount(UInt32 formID)
     {
         if (!IsReady()) return 0;
+        if (s_interface) return s_interface->GetKeywordCount(formID);
 
         BasicData data = { formID, nullptr, false, 0 };
         s_msgIntfc->Dispatch(s_pluginHandle, kMessage_GetCount,
@@ -162,6 +435,11 @@ namespace KeywordAPI
     inline void ClearKeywords(UInt32 formID)
     {
         if (!IsReady()) return;
+        if (s_interface)
+        {
+            s_interface->ClearKeywords(formID);
+            return;
+        }
 
         BasicData data = { formID, nullptr, false, 0 };
         s_msgIntfc->Dispatch(s_pluginHandle, kMessage_Clear,
@@ -184,6 +462,61 @@ namespace KeywordAPI
         return data.keyword;
     }
 
+    // ---- GetKeywords ----
+    // All of a form's keywords, as pointers into OBSEKeywords's interned
+    // names, without copying any string.  See GetKeywordsData for how long
+    // the pointers stay valid.
+    //
+    // Against an OBSEKeywords too old for kMessage_GetKeywords, the names
+    // are fetched one by one with GetNthKeyword instead, and the copies are
+    // kept for the rest of the session.
+
+    inline std::vector<const char*> GetKeywords(UInt32 formID)
+    {
+        std::vector<const char*> keywords;
+        if (!IsReady()) return keywords;
+
+        // A version 1 or 2 interface means a server without the message
+        bool answered = !s_interface || s_interface->version >= 3;
+
+        // Most forms carry only a few keywords, so one call usually does
+        keywords.resize(16);
+        for (int attempt = 0; answered && attempt < 2; ++attempt)
+        {
+            UInt32 count;
+            if (s_interface)
+            {
+                count = s_interface->GetKeywordNames(formID, keywords.data(), keywords.size());
+            }
+            else
+            {
+                // Left as is by servers that do not handle the message
+                const UInt32 kUnanswered = 0xFFFFFFFF;
+                GetKeywordsData data = { formID, keywords.data(), nullptr, (UInt32)keywords.size(), kUnanswered };
+                s_msgIntfc->Dispatch(s_pluginHandle, kMessage_GetKeywords,
+                    &data, sizeof(data), nullptr);
+                count = data.count;
+                answered = count != kUnanswered;
+                if (!answered) break;
+            }
+
+            bool fits = count <= keywords.size();
+            keywords.resize(count);
+            if (fits) return keywords;
+        }
+        if (answered) return keywords;
+
+        keywords.clear();
+        UInt32 count = GetKeywordCount(formID);
+        for (UInt32 i = 0; i < count; ++i)
+        {
+            std::string keyword = GetNthKeyword(formID, i);
+            if (keyword.empty()) break;
+            keywords.push_back(s_keywordNameCopies.insert(std::move(keyword)).first->c_str());
+        }
+        return keywords;
+    }
+
     // ---- HasAnyKeyword ----
     // Check if form has any of the provided keywords (up to 4).
     // Null-terminate the array early if you have fewer than 4.
@@ -228,4 +561,209 @@ namespace KeywordAPI
             &data, sizeof(data), nullptr);
         return data.result;
     }
+
+    // ---- HasKeywordList ----
+    // Checks a form against any number of keywords in one call:
+    //
+    //   const char* keywords[] = { "Weapon", "Armor", "Clothing", "Jewelry", "Book" };
+    //   if (KeywordAPI::HasKeywordList(formID, keywords, 5, KeywordAPI::kMatch_Any)) { ... }
+    //
+    // Against an OBSEKeywords too old for version 2 queries, string lists
+    // are split into groups of four and sent as kMessage_HasAny / HasAll.
+
+    inline bool HasKeywordList(MultiKeywordDataV2& data)
+    {
+        if (!IsReady()) return false;
+
+        data.version = kMultiKeywordDataVersion;
+        data.size = sizeof(MultiKeywordDataV2);
+        data.result = false;
+        data.serverVersion = 0;
+        if (s_interface && s_interface->version >= 5)
+        {
+            return s_interface->HasKeywordList(&data);
+        }
+
+        s_msgIntfc->Dispatch(s_pluginHandle, kMessage_HasKeywordList,
+            &data, sizeof(data), nullptr);
+        if (data.serverVersion || data.mode > kMatch_None) return data.result;
+
+        // Old server: any/none combine kMessage_HasAny over the groups and
+        // all combines kMessage_HasAll
+        bool matchAll = data.mode == kMatch_All;
+        bool found = matchAll;
+        if (data.keywords)
+        {
+            MultiKeywordData group = {};
+            group.formID = data.formID;
+            UInt32 groupSize = 0;
+            for (UInt32 i = 0; i <= data.count && found == matchAll; ++i)
+            {
+                if (i < data.count)
+                {
+                    if (!data.keywords[i] || !data.keywords[i][0]) continue;
+                    group.keywords[groupSize++] = data.keywords[i];
+                    if (groupSize < 4) continue;
+                }
+                if (!groupSize) break;
+
+                std::fill(group.keywords + groupSize, group.keywords + 4, nullptr);
+                s_msgIntfc->Dispatch(s_pluginHandle, matchAll ? kMessage_HasAll : kMessage_HasAny,
+                    &group, sizeof(group), nullptr);
+                found = group.result;
+                groupSize = 0;
+            }
+        }
+        else if (data.handles && s_interface)
+        {
+            found = matchAll
+                ? s_interface->HasAllKeywordsH(data.formID, data.handles, data.count)
+                : s_interface->HasAnyKeywordH(data.formID, data.handles, data.count);
+        }
+
+        data.result = data.mode == kMatch_None ? !found : found;
+        return data.result;
+    }
+
+    inline bool HasKeywordList(UInt32 formID, const char* const* keywords, UInt32 count, UInt32 mode)
+    {
+        MultiKeywordDataV2 data = {};
+        data.formID = formID;
+        data.mode = mode;
+        data.keywords = keywords;
+        data.count = count;
+        return HasKeywordList(data);
+    }
+
+    inline bool HasKeywordListH(UInt32 formID, const UInt32* handles, UInt32 count, UInt32 mode)
+    {
+        MultiKeywordDataV2 data = {};
+        data.formID = formID;
+        data.mode = mode;
+        data.handles = handles;
+        data.count = count;
+        return HasKeywordList(data);
+    }
+
+    // ---- HasKeywordExpr ----
+    // Evaluate a boolean keyword expression against a form.
+    // Operators: | (any), & (all), ! (not), parentheses for grouping.
+    // The expression is compiled once on the OBSEKeywords side and cached
+    // by its text, so reusing the same string is cheap.
+
+    inline bool HasKeywordExpr(UInt32 formID, const char* expression)
+    {
+        if (!IsReady() || !expression) return false;
+        if (s_interface) return s_interface->HasKeywordExpr(formID, expression);
+
+        ExprData data = { formID, expression, false, false };
+        s_msgIntfc->Dispatch(s_pluginHandle, kMessage_HasExpr,
+            &data, sizeof(data), nullptr);
+        return data.result;
+    }
+
+    // ---- HasKeywordsBatch ----
+    // Classifies many forms at once, e.g. a whole inventory, in one call
+    // instead of one HasKeyword per form per keyword.  Returns false if
+    // OBSEKeywords is not ready or too old, leaving the outputs untouched.
+    //
+    //   const char* keywords[] = { "Weapon", "Armor", "Enchanted" };
+    //   std::vector<UInt64> masks(formIDs.size());
+    //   KeywordAPI::BatchData batch = { formIDs.data(), (UInt32)formIDs.size(),
+    //       keywords, nullptr, 3, nullptr, masks.data(), false };
+    //   KeywordAPI::HasKeywordsBatch(batch);
+
+    inline bool HasKeywordsBatch(BatchData& batch)
+    {
+        if (!IsReady()) return false;
+
+        batch.handled = false;
+        if (s_interface && s_interface->version >= 2)
+        {
+            s_interface->HasKeywordsBatch(&batch);
+        }
+        else
+        {
+            s_msgIntfc->Dispatch(s_pluginHandle, kMessage_HasBatch,
+                &batch, sizeof(batch), nullptr);
+        }
+        return batch.handled;
+    }
+
+    // ---- Subscribe ----
+    // Registers callback for keyword changes, optionally filtered by form
+    // and keyword handle.  Returns the subscription ID, or 0 on failure.
+    //
+    //   UInt32 sub = KeywordAPI::Subscribe(OnKeywordsChanged, this);
+    //   ...
+    //   KeywordAPI::FlushChanges();     // once per frame
+
+    inline UInt32 Subscribe(ChangeCallback callback, void* context = nullptr,
+        const UInt32* formIDs = nullptr, UInt32 numForms = 0,
+        const UInt32* handles = nullptr, UInt32 numHandles = 0)
+    {
+        if (!IsReady() || !callback) return 0;
+
+        SubscribeData data = { callback, context, formIDs, numForms, handles, numHandles, 0 };
+        if (s_interface && s_interface->version >= 4)
+        {
+            return s_interface->Subscribe(&data);
+        }
+        s_msgIntfc->Dispatch(s_pluginHandle, kMessage_Subscribe,
+            &data, sizeof(data), nullptr);
+        return data.subscriptionID;
+    }
+
+    inline bool Unsubscribe(UInt32 subscriptionID)
+    {
+        if (!IsReady() || !subscriptionID) return false;
+        if (s_interface && s_interface->version >= 4) return s_interface->Unsubscribe(subscriptionID);
+
+        UnsubscribeData data = { subscriptionID, false };
+        s_msgIntfc->Dispatch(s_pluginHandle, kMessage_Unsubscribe,
+            &data, sizeof(data), nullptr);
+        return data.result;
+    }
+
+    // ---- FlushChanges ----
+    // Delivers the changes collected since the last flush to every
+    // subscriber, before this returns.
+
+    inline void FlushChanges()
+    {
+        if (!IsReady()) return;
+        if (s_interface && s_interface->version >= 4)
+        {
+            s_interface->FlushChanges();
+            return;
+        }
+        s_msgIntfc->Dispatch(s_pluginHandle, kMessage_FlushChanges,
+            nullptr, 0, nullptr);
+    }
+
+    // ---- FindForms ----
+    // Returns every form ID whose keywords match the expression, in
+    // ascending order.  Uses the reverse index, so it does not scan forms:
+    // "Weapon & Silver & !Unique" intersects and subtracts keyword lists.
+
+    inline std::vector<UInt32> FindForms(const char* expression)
+    {
+        std::vector<UInt32> formIDs;
+        if (!IsReady() || !expression) return formIDs;
+
+        FindFormsData data = { expression, nullptr, 0, 0, false };
+        s_msgIntfc->Dispatch(s_pluginHandle, kMessage_FindForms,
+            &data, sizeof(data), nullptr);
+
+        if (data.count > 0)
+        {
+            formIDs.resize(data.count);
+            data.formIDs = formIDs.data();
+            data.capacity = data.count;
+            s_msgIntfc->Dispatch(s_pluginHandle, kMessage_FindForms,
+                &data, sizeof(data), nullptr);
+            formIDs.resize(std::min(data.count, data.capacity));
+        }
+        return formIDs;
+    }
 }
\ No newline at end of file
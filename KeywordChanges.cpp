@@ -0,0 +1,177 @@
+#include "KeywordChanges.h"
+#include "Keywords.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    struct Subscriber
+    {
+        UInt32                     id;
+        KeywordAPI::ChangeCallback callback;    // null once unsubscribed during a flush
+        void*                      context;
+        std::vector<UInt32>        formIDs;     // sorted; empty for every form
+        std::vector<UInt32>        keywordIDs;  // sorted; empty for every keyword
+
+        bool Filtered() const
+        {
+            return !formIDs.empty() || !keywordIDs.empty();
+        }
+
+        bool Wants(const KeywordAPI::KeywordChange& change) const
+        {
+            return (formIDs.empty() || std::binary_search(formIDs.begin(), formIDs.end(), change.formID))
+                && (keywordIDs.empty() || std::binary_search(keywordIDs.begin(), keywordIDs.end(), change.handle));
+        }
+    };
+
+    std::vector<Subscriber> s_subscribers;
+    UInt32                  s_nextSubscriptionID = 1;
+    bool                    s_delivering = false;
+
+    // (formID << 32 | keywordID) -> whether the form had the keyword before
+    // its first change since the last flush
+    std::unordered_map<UInt64, bool> s_pending;
+    UInt32                           s_resetReasons = 0;
+
+    std::vector<UInt32> SortedCopy(const UInt32* values, UInt32 count)
+    {
+        std::vector<UInt32> sorted;
+        if (values) sorted.assign(values, values + count);
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        return sorted;
+    }
+}
+
+void KeywordChangeLog::RecordChange(UInt32 formID, UInt32 keywordID, bool wasSet)
+{
+    // Only the first change since the flush knows the state to compare with
+    s_pending.try_emplace((static_cast<UInt64>(formID) << 32) | keywordID, wasSet);
+}
+
+void KeywordChangeLog::UpdateRecording()
+{
+    recording = !s_subscribers.empty() && !s_resetReasons;
+}
+
+void KeywordChangeLog::BeginReset(UInt32 reason)
+{
+    if (s_subscribers.empty()) return;
+
+    s_resetReasons |= reason;
+    s_pending.clear();
+    UpdateRecording();
+}
+
+void KeywordChangeLog::Flush()
+{
+    // A callback that flushes gets its own changes in the next batch
+    if (s_delivering) return;
+    if (s_pending.empty() && !s_resetReasons) return;
+
+    // The batch is taken out before any callback runs, so changes made by
+    // callbacks are recorded for the next flush
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    UInt32 resetReasons = s_resetReasons;
+    std::vector<KeywordAPI::KeywordChange> changes;
+    if (!resetReasons)
+    {
+        changes.reserve(s_pending.size());
+        for (const auto& [key, wasSet] : s_pending)
+        {
+            UInt32 formID = static_cast<UInt32>(key >> 32);
+            UInt32 keywordID = static_cast<UInt32>(key);
+            bool isSet = mgr->HasKeywordID(formID, keywordID);
+            if (isSet != wasSet)
+            {
+                changes.push_back({ formID, keywordID, isSet });
+            }
+        }
+        std::sort(changes.begin(), changes.end(), [](const auto& a, const auto& b) {
+            return a.formID != b.formID ? a.formID < b.formID : a.handle < b.handle;
+            });
+    }
+    s_pending.clear();
+    s_resetReasons = 0;
+    UpdateRecording();
+
+    if (!resetReasons && changes.empty()) return;
+
+    // Subscribers added by a callback start with the next batch
+    s_delivering = true;
+    std::vector<KeywordAPI::KeywordChange> filtered;
+    UInt32 numSubscribers = s_subscribers.size();
+    for (UInt32 i = 0; i < numSubscribers; ++i)
+    {
+        const Subscriber& subscriber = s_subscribers[i];
+        if (!subscriber.callback) continue;
+
+        KeywordAPI::ChangeBatch batch = { resetReasons, changes.data(), static_cast<UInt32>(changes.size()) };
+        if (!resetReasons && subscriber.Filtered())
+        {
+            filtered.clear();
+            for (const auto& change : changes)
+            {
+                if (subscriber.Wants(change)) filtered.push_back(change);
+            }
+            if (filtered.empty()) continue;
+
+            batch.changes = filtered.data();
+            batch.numChanges = filtered.size();
+        }
+
+        // The callback may subscribe, which can move s_subscribers
+        KeywordAPI::ChangeCallback callback = subscriber.callback;
+        callback(&batch, subscriber.context);
+    }
+    s_delivering = false;
+
+    std::erase_if(s_subscribers, [](const Subscriber& subscriber) {
+        return !subscriber.callback;
+        });
+    UpdateRecording();
+}
+
+UInt32 KeywordChangeLog::Subscribe(const KeywordAPI::SubscribeData& data)
+{
+    if (!data.callback) return 0;
+
+    Subscriber& subscriber = s_subscribers.emplace_back();
+    subscriber.id = s_nextSubscriptionID++;
+    subscriber.callback = data.callback;
+    subscriber.context = data.context;
+    subscriber.formIDs = SortedCopy(data.formIDs, data.numForms);
+    subscriber.keywordIDs = SortedCopy(data.handles, data.numHandles);
+    UpdateRecording();
+
+    _MESSAGE("KeywordChangeLog: subscription %u added (%u form(s), %u keyword(s) in filter)",
+        subscriber.id, (UInt32)subscriber.formIDs.size(), (UInt32)subscriber.keywordIDs.size());
+    return subscriber.id;
+}
+
+bool KeywordChangeLog::Unsubscribe(UInt32 subscriptionID)
+{
+    auto it = std::find_if(s_subscribers.begin(), s_subscribers.end(), [&](const Subscriber& subscriber) {
+        return subscriber.id == subscriptionID && subscriber.callback;
+        });
+    if (it == s_subscribers.end()) return false;
+
+    // Flush is walking the list; it removes the entry when done
+    if (s_delivering)
+    {
+        it->callback = nullptr;
+        return true;
+    }
+
+    s_subscribers.erase(it);
+    UpdateRecording();
+    if (s_subscribers.empty())
+    {
+        s_pending.clear();
+        s_resetReasons = 0;
+    }
+    return true;
+}
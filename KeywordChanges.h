@@ -0,0 +1,48 @@
+#pragma once
+
+#include <KeywordAPI.h>
+
+// ============================================================
+//  Change log for KeywordAPI subscribers
+//
+//  KeywordManager reports every runtime change that flips a
+//  (form, keyword) pair, with the state before the change.  Only
+//  the first report per pair is kept until the next flush, which
+//  compares it against the current state, so a change undone
+//  before the flush is dropped.
+//
+//  Bulk operations (INI loads, save loads, new games) call
+//  BeginReset instead.  Until the next flush nothing is recorded
+//  and the batch carries only the reset reasons, so reloading
+//  thousands of tags costs subscribers a single callback.
+//
+//  Nothing is recorded while there are no subscribers.
+// ============================================================
+
+class KeywordChangeLog
+{
+public:
+    // Called by KeywordManager when formID gains (wasSet false) or loses
+    // (wasSet true) keywordID
+    static void Record(UInt32 formID, UInt32 keywordID, bool wasSet)
+    {
+        if (recording) RecordChange(formID, keywordID, wasSet);
+    }
+
+    // Replaces the pending changes with a reset (KeywordAPI::kReset_*)
+    static void BeginReset(UInt32 reason);
+
+    // Delivers the pending batch to every subscriber
+    static void Flush();
+
+    // Returns the new subscription ID, or 0 if data has no callback
+    static UInt32 Subscribe(const KeywordAPI::SubscribeData& data);
+    static bool Unsubscribe(UInt32 subscriptionID);
+
+private:
+    static void RecordChange(UInt32 formID, UInt32 keywordID, bool wasSet);
+    static void UpdateRecording();
+
+    // Subscribers exist and no reset is pending
+    inline static bool recording = false;
+};
@@ -0,0 +1,325 @@
+#include "KeywordExpr.h"
+#include "Keywords.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+// ============================================================
+//  Parser
+// ============================================================
+
+namespace
+{
+    // Nesting limit, keeps recursion bounded for hostile input
+    const UInt32 kMaxDepth = 32;
+
+    // Expressions are cached by text; dynamically built expressions could
+    // grow the cache without bound, so it is flushed past this size.
+    const size_t kMaxCachedExpressions = 4096;
+
+    struct ParseNode
+    {
+        KeywordExpr::Op        op;
+        UInt32                 keywordID = kInvalidKeywordID;
+        std::vector<ParseNode> children;
+    };
+
+    bool IsOperatorChar(char c)
+    {
+        return c == '&' || c == '|' || c == '!' || c == '(' || c == ')';
+    }
+
+    bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    class Parser
+    {
+    public:
+        Parser(std::string_view text, std::string& error) : text(text), pos(0), error(error) {}
+
+        bool Parse(ParseNode& out)
+        {
+            if (!ParseOr(out, 0)) return false;
+
+            SkipSpace();
+            if (pos < text.size())
+            {
+                // Keywords stop at operator characters, so anything left is
+                // an operator the grammar does not allow here, or a keyword
+                // directly after one, as in "(a) b"
+                if (text[pos] == ')')
+                {
+                    return Fail("unexpected ')'");
+                }
+
+                size_t end = pos + 1;
+                if (!IsOperatorChar(text[pos]))
+                {
+                    while (end < text.size() && !IsOperatorChar(text[end]))
+                    {
+                        ++end;
+                    }
+                    while (IsSpace(text[end - 1]))
+                    {
+                        --end;
+                    }
+                }
+
+                char message[96];
+                snprintf(message, sizeof(message), "unexpected token '%.*s'",
+                    static_cast<int>(std::min<size_t>(end - pos, 32)), text.data() + pos);
+                return Fail(message);
+            }
+            return true;
+        }
+
+    private:
+        bool ParseOr(ParseNode& out, UInt32 depth)
+        {
+            return ParseChain(out, depth, '|', KeywordExpr::kOp_Or, &Parser::ParseAnd);
+        }
+
+        bool ParseAnd(ParseNode& out, UInt32 depth)
+        {
+            return ParseChain(out, depth, '&', KeywordExpr::kOp_And, &Parser::ParseUnary);
+        }
+
+        // operand (sep operand)*, merged into one n-ary node
+        bool ParseChain(ParseNode& out, UInt32 depth, char separator, KeywordExpr::Op op,
+            bool (Parser::*parseOperand)(ParseNode&, UInt32))
+        {
+            ParseNode first;
+            if (!(this->*parseOperand)(first, depth)) return false;
+
+            SkipSpace();
+            if (pos >= text.size() || text[pos] != separator)
+            {
+                out = std::move(first);
+                return true;
+            }
+
+            out.op = op;
+            AppendOperand(out, std::move(first));
+            while (pos < text.size() && text[pos] == separator)
+            {
+                ++pos;
+
+                ParseNode next;
+                if (!(this->*parseOperand)(next, depth)) return false;
+                AppendOperand(out, std::move(next));
+
+                SkipSpace();
+            }
+            return true;
+        }
+
+        // Flattens a & (b & c) into a single three-way And
+        static void AppendOperand(ParseNode& parent, ParseNode&& child)
+        {
+            if (child.op == parent.op)
+            {
+                for (auto& grandchild : child.children)
+                {
+                    parent.children.push_back(std::move(grandchild));
+                }
+            }
+            else
+            {
+                parent.children.push_back(std::move(child));
+            }
+        }
+
+        bool ParseUnary(ParseNode& out, UInt32 depth)
+        {
+            if (depth >= kMaxDepth)
+            {
+                return Fail("expression nested too deeply");
+            }
+
+            SkipSpace();
+            if (pos >= text.size())
+            {
+                return Fail("expected a keyword");
+            }
+
+            if (text[pos] == '!')
+            {
+                ++pos;
+                ParseNode operand;
+                if (!ParseUnary(operand, depth + 1)) return false;
+
+                // !!a == a
+                if (operand.op == KeywordExpr::kOp_Not)
+                {
+                    out = std::move(operand.children[0]);
+                }
+                else
+                {
+                    out.op = KeywordExpr::kOp_Not;
+                    out.children.push_back(std::move(operand));
+                }
+                return true;
+            }
+
+            if (text[pos] == '(')
+            {
+                ++pos;
+                if (!ParseOr(out, depth + 1)) return false;
+
+                SkipSpace();
+                if (pos >= text.size() || text[pos] != ')')
+                {
+                    return Fail("missing ')'");
+                }
+                ++pos;
+                return true;
+            }
+
+            size_t start = pos;
+            while (pos < text.size() && !IsOperatorChar(text[pos]))
+            {
+                ++pos;
+            }
+
+            size_t end = pos;
+            while (end > start && IsSpace(text[end - 1]))
+            {
+                --end;
+            }
+            if (end == start)
+            {
+                return Fail("expected a keyword");
+            }
+
+            // Read-only: a keyword that was never interned is on no form, so
+            // it compiles to kInvalidKeywordID, which matches nothing
+            out.op = KeywordExpr::kOp_Keyword;
+            out.keywordID = KeywordManager::GetSingleton()->FindKeywordID(text.substr(start, end - start));
+            return true;
+        }
+
+        void SkipSpace()
+        {
+            while (pos < text.size() && IsSpace(text[pos]))
+            {
+                ++pos;
+            }
+        }
+
+        bool Fail(const char* message)
+        {
+            char buffer[128];
+            snprintf(buffer, sizeof(buffer), "%s at offset %u", message, static_cast<UInt32>(pos));
+            error = buffer;
+            return false;
+        }
+
+        std::string_view text;
+        size_t           pos;
+        std::string&     error;
+    };
+
+    // Writes node in prefix order and returns its subtree size
+    UInt32 Flatten(const ParseNode& node, std::vector<KeywordExpr::Node>& out)
+    {
+        size_t index = out.size();
+        out.push_back({ node.op, 0, 1 });
+
+        if (node.op == KeywordExpr::kOp_Keyword)
+        {
+            out[index].arg = node.keywordID;
+            return 1;
+        }
+
+        UInt32 size = 1;
+        for (const auto& child : node.children)
+        {
+            size += Flatten(child, out);
+        }
+        out[index].arg = node.children.size();
+        out[index].size = size;
+        return size;
+    }
+}
+
+bool KeywordExpr::Compile(std::string_view text, std::string& outError)
+{
+    nodes.clear();
+
+    ParseNode root;
+    Parser parser(text, outError);
+    if (!parser.Parse(root))
+    {
+        return false;
+    }
+
+    Flatten(root, nodes);
+    return true;
+}
+
+// ============================================================
+//  Cache
+// ============================================================
+
+namespace
+{
+    struct ExprTextHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view text) const
+        {
+            return std::hash<std::string_view>()(text);
+        }
+    };
+
+    // Invalid entries are kept too, so a broken expression is reported once
+    std::unordered_map<std::string, KeywordExpr, ExprTextHash, std::equal_to<>> s_exprCache;
+
+    // Set once any cached expression names a keyword that was not interned
+    bool s_hasUnknownKeywords = false;
+
+    bool NamesUnknownKeyword(const KeywordExpr& expr)
+    {
+        for (const KeywordExpr::Node& node : expr.GetNodes())
+        {
+            if (node.op == KeywordExpr::kOp_Keyword && node.arg == kInvalidKeywordID) return true;
+        }
+        return false;
+    }
+}
+
+const KeywordExpr* KeywordExprCache::Get(std::string_view text)
+{
+    auto it = s_exprCache.find(text);
+    if (it == s_exprCache.end())
+    {
+        if (s_exprCache.size() >= kMaxCachedExpressions)
+        {
+            s_exprCache.clear();
+        }
+
+        KeywordExpr expr;
+        std::string error;
+        if (!expr.Compile(text, error))
+        {
+            _WARNING("KeywordExpr: cannot parse '%.*s': %s",
+                static_cast<int>(text.size()), text.data(), error.c_str());
+        }
+
+        s_hasUnknownKeywords = s_hasUnknownKeywords || NamesUnknownKeyword(expr);
+        it = s_exprCache.emplace(std::string(text), std::move(expr)).first;
+    }
+
+    return it->second.IsValid() ? &it->second : nullptr;
+}
+
+void KeywordExprCache::OnKeywordInterned()
+{
+    if (!s_hasUnknownKeywords) return;
+
+    std::erase_if(s_exprCache, [](const auto& entry) { return NamesUnknownKeyword(entry.second); });
+    s_hasUnknownKeywords = false;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================
+//  Keyword query expressions
+//
+//  Boolean expressions over keywords, e.g.
+//
+//      Weapon & (Blade | Axe) & !Broken
+//
+//  Operators, from lowest to highest precedence:
+//      a | b       any of
+//      a & b       all of
+//      !a          not
+//      ( ... )     grouping
+//
+//  A keyword is any run of other characters, trimmed, so
+//  keywords may contain inner spaces.  Matching is
+//  case-insensitive like everywhere else.
+//
+//  An expression is parsed once into a flat prefix-order node
+//  array.  Chains of the same operator are merged into a single
+//  n-ary node, and every node records the size of its subtree
+//  so evaluation can short-circuit by skipping over siblings.
+// ============================================================
+
+class KeywordExpr
+{
+public:
+    enum Op : UInt8
+    {
+        kOp_Keyword,    // arg = keyword ID, kInvalidKeywordID if unknown
+        kOp_Not,        // one child
+        kOp_And,        // arg = child count
+        kOp_Or,         // arg = child count
+    };
+
+    struct Node
+    {
+        Op     op;
+        UInt32 arg;
+        UInt32 size;    // nodes in this subtree, including itself
+    };
+
+    // Parses and compiles text.  Keywords are looked up, not interned, so
+    // one that was never interned matches no form.  On failure returns false,
+    // leaves the expression invalid and describes the problem in outError.
+    bool Compile(std::string_view text, std::string& outError);
+
+    bool IsValid() const { return !nodes.empty(); }
+    const std::vector<Node>& GetNodes() const { return nodes; }
+
+    // Evaluates the expression; hasKeyword(keywordID) reports whether the
+    // form being tested carries that keyword.
+    template <class Pred>
+    bool Evaluate(Pred&& hasKeyword) const
+    {
+        return IsValid() && EvaluateNode(0, hasKeyword);
+    }
+
+private:
+    template <class Pred>
+    bool EvaluateNode(UInt32 index, Pred& hasKeyword) const
+    {
+        const Node& node = nodes[index];
+        switch (node.op)
+        {
+        case kOp_Keyword:
+            return hasKeyword(node.arg);
+
+        case kOp_Not:
+            return !EvaluateNode(index + 1, hasKeyword);
+
+        case kOp_And:
+        case kOp_Or:
+        {
+            // And stops at the first false child, Or at the first true one
+            bool stopOn = node.op == kOp_Or;
+            UInt32 child = index + 1;
+            for (UInt32 i = 0; i < node.arg; ++i)
+            {
+                if (EvaluateNode(child, hasKeyword) == stopOn)
+                {
+                    return stopOn;
+                }
+                child += nodes[child].size;
+            }
+            return !stopOn;
+        }
+        }
+        return false;
+    }
+
+    std::vector<Node> nodes;
+};
+
+// Compiled expressions cached by their source text, so a script that
+// evaluates the same expression every frame parses it only once.
+class KeywordExprCache
+{
+public:
+    // Returns the compiled expression, or nullptr if the text does not parse.
+    // Parse errors are logged once per distinct expression.
+    static const KeywordExpr* Get(std::string_view text);
+
+    // Called by KeywordManager::InternKeyword for each new keyword.  Cached
+    // expressions compiled it as unknown, so those that name an unknown
+    // keyword are dropped and compiled again on their next use.  Pointers
+    // returned by Get() do not survive this.
+    static void OnKeywordInterned();
+};
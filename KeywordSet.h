@@ -0,0 +1,429 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ============================================================
+//  Per-form keyword storage
+//
+//  KeywordSet holds the keyword IDs attached to one form.  By
+//  default it is a sorted ID list, which is compact for the
+//  handful of keywords most forms carry.
+//
+//  Either way the data lives in an InlineVector, so a typical
+//  form (up to 8 IDs, or IDs below 256 in bitset mode) is stored
+//  entirely inside its FormMap slot and never touches the heap.
+//
+//  Define KEYWORDS_BITSET_STORAGE=1 (e.g. in the project's
+//  preprocessor definitions) to store each form's keywords as a
+//  bitset indexed by keyword ID instead.  Any-of / all-of checks
+//  then become a word-wise AND and compare, at the cost of
+//  (highest keyword ID / 8) bytes per form.
+// ============================================================
+
+#ifndef KEYWORDS_BITSET_STORAGE
+#define KEYWORDS_BITSET_STORAGE 0
+#endif
+
+// Vector of trivially copyable values with room for N of them inline.
+// Spills to a heap array when it grows past N.
+template <class T, UInt32 N>
+class InlineVector
+{
+    static_assert(std::is_trivially_copyable_v<T>, "InlineVector holds plain values only");
+
+public:
+    InlineVector() : size(0), capacity(N) {}
+
+    InlineVector(const InlineVector& other) : size(0), capacity(N)
+    {
+        Reserve(other.size);
+        std::memcpy(Data(), other.Data(), other.size * sizeof(T));
+        size = other.size;
+    }
+
+    InlineVector(InlineVector&& other) noexcept : size(0), capacity(N)
+    {
+        Steal(other);
+    }
+
+    InlineVector& operator=(const InlineVector& other)
+    {
+        if (this != &other)
+        {
+            size = 0;
+            Reserve(other.size);
+            std::memcpy(Data(), other.Data(), other.size * sizeof(T));
+            size = other.size;
+        }
+        return *this;
+    }
+
+    InlineVector& operator=(InlineVector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+            Steal(other);
+        }
+        return *this;
+    }
+
+    ~InlineVector() { Release(); }
+
+    T* Data() { return IsInline() ? inlineData : heapData; }
+    const T* Data() const { return IsInline() ? inlineData : heapData; }
+    T* begin() { return Data(); }
+    T* end() { return Data() + size; }
+    const T* begin() const { return Data(); }
+    const T* end() const { return Data() + size; }
+    T& operator[](UInt32 i) { return Data()[i]; }
+    const T& operator[](UInt32 i) const { return Data()[i]; }
+    T& Back() { return Data()[size - 1]; }
+
+    UInt32 Size() const { return size; }
+    bool Empty() const { return size == 0; }
+    bool IsInline() const { return capacity == N; }
+    UInt32 HeapBytes() const { return IsInline() ? 0 : capacity * sizeof(T); }
+
+    void Reserve(UInt32 count)
+    {
+        if (count <= capacity) return;
+
+        UInt32 newCapacity = capacity * 2;
+        while (newCapacity < count)
+        {
+            newCapacity *= 2;
+        }
+
+        T* newData = new T[newCapacity];
+        std::memcpy(newData, Data(), size * sizeof(T));
+        Release();
+        heapData = newData;
+        capacity = newCapacity;
+    }
+
+    void Insert(UInt32 pos, T value)
+    {
+        Reserve(size + 1);
+        T* data = Data();
+        std::memmove(data + pos + 1, data + pos, (size - pos) * sizeof(T));
+        data[pos] = value;
+        ++size;
+    }
+
+    void Erase(UInt32 pos)
+    {
+        T* data = Data();
+        std::memmove(data + pos, data + pos + 1, (size - pos - 1) * sizeof(T));
+        --size;
+    }
+
+    void Resize(UInt32 newSize, T value = T())
+    {
+        Reserve(newSize);
+        std::fill(Data() + size, Data() + std::max(size, newSize), value);
+        size = newSize;
+    }
+
+    void Assign(const T* values, UInt32 count)
+    {
+        size = 0;
+        Reserve(count);
+        std::memcpy(Data(), values, count * sizeof(T));
+        size = count;
+    }
+
+    void PopBack() { --size; }
+
+private:
+    void Release()
+    {
+        if (!IsInline())
+        {
+            delete[] heapData;
+            capacity = N;
+        }
+    }
+
+    void Steal(InlineVector& other)
+    {
+        if (other.IsInline())
+        {
+            std::memcpy(inlineData, other.inlineData, other.size * sizeof(T));
+        }
+        else
+        {
+            heapData = other.heapData;
+            capacity = other.capacity;
+            other.capacity = N;
+        }
+        size = other.size;
+        other.size = 0;
+    }
+
+    UInt32 size;
+    UInt32 capacity;    // == N while the data is inline
+    union
+    {
+        T  inlineData[N];
+        T* heapData;
+    };
+};
+
+// Set of keyword IDs used as the right-hand side of any-of / all-of
+// queries.  The first 1024 IDs live inline so building a mask for a
+// script command never touches the heap.
+class KeywordMask
+{
+public:
+    static const UInt32 kInlineWords = 16;   // 1024 keyword IDs
+
+    KeywordMask() : inlineWords{}, numWords(0), count(0) {}
+
+    void Set(UInt32 keywordID)
+    {
+        UInt32 word = keywordID >> 6;
+        if (word >= numWords)
+        {
+            Grow(word + 1);
+        }
+
+        UInt64 bit = 1ull << (keywordID & 63);
+        UInt64* words = Words();
+        if (!(words[word] & bit))
+        {
+            words[word] |= bit;
+            ++count;
+        }
+    }
+
+    bool Test(UInt32 keywordID) const
+    {
+        UInt32 word = keywordID >> 6;
+        return word < numWords && (Words()[word] & (1ull << (keywordID & 63))) != 0;
+    }
+
+    void Clear()
+    {
+        std::fill(Words(), Words() + numWords, 0);
+        count = 0;
+    }
+
+    UInt32 Count() const { return count; }
+    bool Empty() const { return count == 0; }
+
+    UInt32 NumWords() const { return numWords; }
+    const UInt64* Words() const { return heapWords.empty() ? inlineWords : heapWords.data(); }
+
+private:
+    UInt64* Words() { return heapWords.empty() ? inlineWords : heapWords.data(); }
+
+    void Grow(UInt32 newNumWords)
+    {
+        if (newNumWords > kInlineWords && heapWords.size() < newNumWords)
+        {
+            if (heapWords.empty())
+            {
+                heapWords.assign(inlineWords, inlineWords + numWords);
+            }
+            heapWords.resize(newNumWords, 0);
+        }
+        numWords = newNumWords;
+    }
+
+    UInt64              inlineWords[kInlineWords];
+    std::vector<UInt64> heapWords;
+    UInt32              numWords;
+    UInt32              count;
+};
+
+#if KEYWORDS_BITSET_STORAGE
+
+class KeywordSet
+{
+public:
+    bool Insert(UInt32 keywordID)
+    {
+        UInt32 word = keywordID >> 6;
+        if (word >= words.Size())
+        {
+            words.Resize(word + 1, 0);
+        }
+
+        UInt64 bit = 1ull << (keywordID & 63);
+        if (words[word] & bit) return false;
+        words[word] |= bit;
+        return true;
+    }
+
+    bool Erase(UInt32 keywordID)
+    {
+        UInt32 word = keywordID >> 6;
+        UInt64 bit = 1ull << (keywordID & 63);
+        if (word >= words.Size() || !(words[word] & bit)) return false;
+
+        words[word] &= ~bit;
+        while (!words.Empty() && words.Back() == 0)
+        {
+            words.PopBack();
+        }
+        return true;
+    }
+
+    bool Contains(UInt32 keywordID) const
+    {
+        UInt32 word = keywordID >> 6;
+        return word < words.Size() && (words[word] & (1ull << (keywordID & 63))) != 0;
+    }
+
+    UInt32 Size() const
+    {
+        UInt32 size = 0;
+        for (UInt64 w : words)
+        {
+            size += std::popcount(w);
+        }
+        return size;
+    }
+
+    bool Empty() const { return words.Empty(); }
+    bool IsInline() const { return words.IsInline(); }
+    UInt32 HeapBytes() const { return words.HeapBytes(); }
+
+    // Replaces the contents with count keyword IDs (any order, no duplicates)
+    void Assign(const UInt32* keywordIDs, UInt32 count)
+    {
+        words.Resize(0);
+        for (UInt32 i = 0; i < count; ++i)
+        {
+            Insert(keywordIDs[i]);
+        }
+    }
+
+    // Calls func(keywordID) in ascending ID order
+    template <class Func>
+    void ForEach(Func&& func) const
+    {
+        for (UInt32 i = 0; i < words.Size(); ++i)
+        {
+            for (UInt64 w = words[i]; w; w &= w - 1)
+            {
+                func((i << 6) | std::countr_zero(w));
+            }
+        }
+    }
+
+    // The loops below avoid early exits so the compiler can vectorize them
+
+    bool ContainsAny(const KeywordMask& mask) const
+    {
+        const UInt64* maskWords = mask.Words();
+        UInt32 n = std::min<UInt32>(words.Size(), mask.NumWords());
+
+        UInt64 hit = 0;
+        for (UInt32 i = 0; i < n; ++i)
+        {
+            hit |= words[i] & maskWords[i];
+        }
+        return hit != 0;
+    }
+
+    bool ContainsAll(const KeywordMask& mask) const
+    {
+        const UInt64* maskWords = mask.Words();
+        UInt32 n = std::min<UInt32>(words.Size(), mask.NumWords());
+
+        UInt64 missing = 0;
+        for (UInt32 i = 0; i < n; ++i)
+        {
+            missing |= maskWords[i] & ~words[i];
+        }
+        for (UInt32 i = n; i < mask.NumWords(); ++i)
+        {
+            missing |= maskWords[i];
+        }
+        return missing == 0;
+    }
+
+private:
+    InlineVector<UInt64, 4> words;     // IDs below 256 stay inline
+};
+
+#else
+
+class KeywordSet
+{
+public:
+    bool Insert(UInt32 keywordID)
+    {
+        const UInt32* pos = std::lower_bound(ids.begin(), ids.end(), keywordID);
+        if (pos != ids.end() && *pos == keywordID) return false;
+        ids.Insert(pos - ids.begin(), keywordID);
+        return true;
+    }
+
+    bool Erase(UInt32 keywordID)
+    {
+        const UInt32* pos = std::lower_bound(ids.begin(), ids.end(), keywordID);
+        if (pos == ids.end() || *pos != keywordID) return false;
+        ids.Erase(pos - ids.begin());
+        return true;
+    }
+
+    bool Contains(UInt32 keywordID) const
+    {
+        return std::binary_search(ids.begin(), ids.end(), keywordID);
+    }
+
+    UInt32 Size() const { return ids.Size(); }
+    bool Empty() const { return ids.Empty(); }
+    bool IsInline() const { return ids.IsInline(); }
+    UInt32 HeapBytes() const { return ids.HeapBytes(); }
+
+    // Replaces the contents with count keyword IDs (any order, no duplicates)
+    void Assign(const UInt32* keywordIDs, UInt32 count)
+    {
+        ids.Assign(keywordIDs, count);
+        std::sort(ids.begin(), ids.end());
+    }
+
+    // Calls func(keywordID) in ascending ID order
+    template <class Func>
+    void ForEach(Func&& func) const
+    {
+        for (UInt32 keywordID : ids)
+        {
+            func(keywordID);
+        }
+    }
+
+    bool ContainsAny(const KeywordMask& mask) const
+    {
+        for (UInt32 keywordID : ids)
+        {
+            if (mask.Test(keywordID)) return true;
+        }
+        return false;
+    }
+
+    bool ContainsAll(const KeywordMask& mask) const
+    {
+        // IDs are unique, so matching mask.Count() of them means all are present
+        UInt32 matched = 0;
+        for (UInt32 keywordID : ids)
+        {
+            matched += mask.Test(keywordID);
+        }
+        return matched == mask.Count();
+    }
+
+private:
+    InlineVector<UInt32, 8> ids;    // sorted ascending
+};
+
+#endif
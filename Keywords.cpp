@@ -1,6 +1,10 @@
 #include "Keywords.h"
 #include "INIParser.h"
+#include "ByteStream.h"
+#include "KeywordChanges.h"
 #include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <obse/StringVar.h>
 #include <obse/GameObjects.h>
 
@@ -9,6 +13,14 @@ KeywordManager* KeywordManager::instance = nullptr;
 
 // ===== KeywordManager Implementation =====
 
+KeywordManager::KeywordManager()
+{
+    // Reserve ID 0 so that a zero handle never names a real keyword
+    keywordNames.emplace_back();
+    runtimeForms.emplace_back();
+    shadowedForms.emplace_back();
+}
+
 KeywordManager* KeywordManager::GetSingleton()
 {
     if (!instance)
@@ -18,154 +30,1068 @@ KeywordManager* KeywordManager::GetSingleton()
     return instance;
 }
 
-bool KeywordManager::AddKeyword(UInt32 formID, const std::string& keyword)
+UInt32 KeywordManager::InternKeyword(std::string_view keyword)
+{
+    if (keyword.empty()) return kInvalidKeywordID;
+
+    auto it = keywordIDs.find(keyword);
+    if (it != keywordIDs.end())
+    {
+        return it->second;
+    }
+
+    // Only a new keyword pays for a lowercase copy
+    std::string& lowerKeyword = keywordNames.emplace_back(keyword);
+    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), FoldKeywordChar);
+
+    UInt32 keywordID = keywordNames.size() - 1;
+    runtimeForms.emplace_back();
+    shadowedForms.emplace_back();
+    keywordIDs.emplace(lowerKeyword, keywordID);
+
+    UInt32 handle = ScriptHandleOf(lowerKeyword);
+    UInt32& handleOwner = scriptHandles[handle];
+    if (handleOwner == kInvalidKeywordID)
+    {
+        handleOwner = keywordID;
+    }
+    else if (handleOwner != kAmbiguousScriptHandle)
+    {
+        _WARNING("Keywords \"%s\" and \"%s\" share script handle %u; it will match neither",
+            keywordNames[handleOwner].c_str(), lowerKeyword.c_str(), handle);
+        handleOwner = kAmbiguousScriptHandle;
+    }
+
+    KeywordExprCache::OnKeywordInterned();
+    return keywordID;
+}
+
+UInt32 KeywordManager::FindKeywordID(std::string_view keyword) const
+{
+    auto it = keywordIDs.find(keyword);
+    if (it != keywordIDs.end())
+    {
+        return it->second;
+    }
+    return kInvalidKeywordID;
+}
+
+UInt32 KeywordManager::ScriptHandleOf(std::string_view keyword)
+{
+    UInt32 handle = KeywordHash()(keyword) & 0x7FFFFFFF;
+    return handle ? handle : 1;
+}
+
+UInt32 KeywordManager::GetScriptHandle(UInt32 keywordID) const
+{
+    if (keywordID == kInvalidKeywordID || keywordID >= keywordNames.size())
+    {
+        return 0;
+    }
+
+    UInt32 handle = ScriptHandleOf(keywordNames[keywordID]);
+    return ResolveScriptHandle(handle) == keywordID ? handle : 0;
+}
+
+UInt32 KeywordManager::ResolveScriptHandle(UInt32 handle) const
+{
+    const UInt32* keywordID = scriptHandles.Find(handle);
+    if (!keywordID || *keywordID == kAmbiguousScriptHandle)
+    {
+        return kInvalidKeywordID;
+    }
+    return *keywordID;
+}
+
+const char* KeywordManager::GetKeywordName(UInt32 keywordID) const
+{
+    if (keywordID >= keywordNames.size())
+    {
+        return "";
+    }
+    return keywordNames[keywordID].c_str();
+}
+
+bool KeywordManager::AddKeyword(UInt32 formID, std::string_view keyword, KeywordSource source)
+{
+    return AddKeywordID(formID, InternKeyword(keyword), source);
+}
+
+bool KeywordManager::AddKeywordID(UInt32 formID, UInt32 keywordID, KeywordSource source)
 {
-    if (keyword.empty()) return false;
+    if (!formID) return false;
+    if (keywordID == kInvalidKeywordID || keywordID >= keywordNames.size()) return false;
 
-    std::string lowerKeyword = keyword;
-    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+    if (source == kSource_INI)
+    {
+        // Only written while BuildBaseline runs, which then freezes it
+        iniStaging[formID].Insert(keywordID);
+        return true;
+    }
 
-    formKeywords[formID].insert(lowerKeyword);
-    keywordForms[lowerKeyword].insert(formID);
+    if (HasKeywordID(formID, keywordID)) return true;
 
+    EditKeywords(formID).Insert(keywordID);
+    runtimeForms[keywordID].Add(formID);
+    KeywordChangeLog::Record(formID, keywordID, false);
     return true;
 }
 
-bool KeywordManager::RemoveKeyword(UInt32 formID, const std::string& keyword)
+void KeywordManager::AddKeywordIDs(UInt32 formID, UInt32* keywordIDs, UInt32 count)
 {
-    std::string lowerKeyword = keyword;
-    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+    if (!formID) return;
+
+    UInt32* end = std::remove_if(keywordIDs, keywordIDs + count, [this](UInt32 keywordID) {
+        return keywordID == kInvalidKeywordID || keywordID >= keywordNames.size();
+        });
+    std::sort(keywordIDs, end);
+    count = std::unique(keywordIDs, end) - keywordIDs;
+    if (!count) return;
 
-    auto formIt = formKeywords.find(formID);
-    if (formIt != formKeywords.end())
+    KeywordSet& keywords = EditKeywords(formID);
+    if (keywords.Empty())
     {
-        formIt->second.erase(lowerKeyword);
-        if (formIt->second.empty())
+        // A form seen for the first time (the usual case while loading)
+        // takes the whole list in one copy
+        keywords.Assign(keywordIDs, count);
+        for (UInt32 i = 0; i < count; ++i)
         {
-            formKeywords.erase(formIt);
+            runtimeForms[keywordIDs[i]].Add(formID);
+            KeywordChangeLog::Record(formID, keywordIDs[i], false);
         }
+        return;
     }
 
-    auto keywordIt = keywordForms.find(lowerKeyword);
-    if (keywordIt != keywordForms.end())
+    for (UInt32 i = 0; i < count; ++i)
     {
-        keywordIt->second.erase(formID);
-        if (keywordIt->second.empty())
+        if (keywords.Insert(keywordIDs[i]))
         {
-            keywordForms.erase(keywordIt);
+            runtimeForms[keywordIDs[i]].Add(formID);
+            KeywordChangeLog::Record(formID, keywordIDs[i], false);
         }
     }
+}
+
+bool KeywordManager::RemoveKeyword(UInt32 formID, std::string_view keyword)
+{
+    UInt32 keywordID = FindKeywordID(keyword);
+    if (keywordID == kInvalidKeywordID) return true;
 
+    RemoveKeywordID(formID, keywordID);
     return true;
 }
 
-bool KeywordManager::HasKeyword(UInt32 formID, const std::string& keyword)
+void KeywordManager::RemoveKeywordID(UInt32 formID, UInt32 keywordID)
+{
+    if (!HasKeywordID(formID, keywordID)) return;
+
+    KeywordSet& keywords = EditKeywords(formID);
+    keywords.Erase(keywordID);
+    runtimeForms[keywordID].Remove(formID);
+    KeywordChangeLog::Record(formID, keywordID, true);
+
+    // An empty runtime entry is only needed to hide INI keywords
+    if (keywords.Empty() && baseKeywords.Find(formID).Empty())
+    {
+        runtimeKeywords.Erase(formID);
+    }
+}
+
+// ===== Layers =====
+
+KeywordSet& KeywordManager::EditKeywords(UInt32 formID)
+{
+    if (KeywordSet* keywords = runtimeKeywords.Find(formID))
+    {
+        return *keywords;
+    }
+
+    // First runtime edit: copy the INI keywords up, which hides the INI entry
+    KeywordSet& keywords = runtimeKeywords[formID];
+    KeywordSpan base = baseKeywords.Find(formID);
+    if (!base.Empty())
+    {
+        keywords.Assign(base.Data(), base.Size());
+        base.ForEach([&](UInt32 keywordID) {
+            shadowedForms[keywordID].Add(formID);
+            runtimeForms[keywordID].Add(formID);
+            });
+    }
+    return keywords;
+}
+
+void KeywordManager::DropRuntimeEdit(UInt32 formID)
+{
+    const KeywordSet* keywords = runtimeKeywords.Find(formID);
+    if (!keywords) return;
+
+    keywords->ForEach([&](UInt32 keywordID) {
+        runtimeForms[keywordID].Remove(formID);
+        });
+    baseKeywords.Find(formID).ForEach([&](UInt32 keywordID) {
+        shadowedForms[keywordID].Remove(formID);
+        });
+    runtimeKeywords.Erase(formID);
+}
+
+UInt32 KeywordManager::CountKeywordForms(UInt32 keywordID) const
+{
+    // Shadowed forms are a subset of the INI list, and the runtime list is
+    // disjoint from what is left of it
+    return baseKeywords.CountForms(keywordID) - shadowedForms[keywordID].Size() + runtimeForms[keywordID].Size();
+}
+
+void KeywordManager::CollectKeywordForms(UInt32 keywordID, std::vector<UInt32>& outFormIDs)
+{
+    const auto& shadowed = shadowedForms[keywordID].Get();
+    const auto& runtime = runtimeForms[keywordID].Get();
+
+    UInt32 baseCount;
+    const UInt32* base = baseKeywords.GetForms(keywordID, baseCount);
+    outFormIDs.assign(base, base + baseCount);
+    PostingOps::SubtractInto(outFormIDs, shadowed.data(), shadowed.size());
+    PostingOps::UnionInto(outFormIDs, runtime.data(), runtime.size());
+}
+
+std::vector<UInt32> KeywordManager::GetTaggedForms() const
+{
+    std::vector<UInt32> formIDs;
+    formIDs.reserve(baseKeywords.NumForms() + runtimeKeywords.Size());
+
+    baseKeywords.ForEach([&](UInt32 formID, KeywordSpan) {
+        if (!runtimeKeywords.Find(formID)) formIDs.push_back(formID);
+        });
+    runtimeKeywords.ForEach([&](UInt32 formID, const KeywordSet& keywords) {
+        if (!keywords.Empty()) formIDs.push_back(formID);
+        });
+
+    std::sort(formIDs.begin(), formIDs.end());
+    return formIDs;
+}
+
+namespace
+{
+    struct RuntimeEdit
+    {
+        UInt32              formID;
+        std::vector<UInt32> added;
+        std::vector<UInt32> removed;
+    };
+
+    // Splits a runtime-edited form's keywords into those gained and those
+    // lost relative to its INI keywords
+    void DiffKeywords(const KeywordSet& current, KeywordSpan base,
+        std::vector<UInt32>& outAdded, std::vector<UInt32>& outRemoved)
+    {
+        outAdded.clear();
+        outRemoved.clear();
+
+        current.ForEach([&](UInt32 keywordID) {
+            if (!base.Contains(keywordID)) outAdded.push_back(keywordID);
+            });
+        base.ForEach([&](UInt32 keywordID) {
+            if (!current.Contains(keywordID)) outRemoved.push_back(keywordID);
+            });
+    }
+
+    void ReapplyEdits(KeywordManager* mgr, std::vector<RuntimeEdit>& edits)
+    {
+        for (RuntimeEdit& edit : edits)
+        {
+            mgr->AddKeywordIDs(edit.formID, edit.added.data(), edit.added.size());
+            for (UInt32 keywordID : edit.removed)
+            {
+                mgr->RemoveKeywordID(edit.formID, keywordID);
+            }
+        }
+    }
+}
+
+void KeywordManager::BuildBaseline(const std::function<void()>& loadINIs)
+{
+    auto start = std::chrono::steady_clock::now();
+    KeywordChangeLog::BeginReset(KeywordAPI::kReset_INI);
+
+    // Runtime edits survive a rebuild as changes against the old INI keywords
+    std::vector<RuntimeEdit> edits;
+    edits.reserve(runtimeKeywords.Size());
+    runtimeKeywords.ForEach([&](UInt32 formID, const KeywordSet& keywords) {
+        RuntimeEdit& edit = edits.emplace_back();
+        edit.formID = formID;
+        DiffKeywords(keywords, baseKeywords.Find(formID), edit.added, edit.removed);
+        });
+
+    ClearAllKeywords();
+    loadINIs();
+
+    baseKeywords.Build(iniStaging, keywordNames.size());
+    if (!iniStagingPairs.empty())
+    {
+        baseKeywords.Patch(iniStagingPairs, {}, keywordNames.size());
+    }
+    iniStaging = FormMap<KeywordSet>();
+    std::vector<UInt64>().swap(iniStagingPairs);
+
+    ReapplyEdits(this, edits);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _MESSAGE("INI baseline: %u forms, %u tags (%u KB) built in %.1f ms, %u runtime edit(s) re-applied",
+        baseKeywords.NumForms(), baseKeywords.NumTags(), baseKeywords.Bytes() / 1024, ms, (UInt32)edits.size());
+}
+
+void KeywordManager::AddBaselinePairs(std::vector<UInt64>&& pairs)
+{
+    if (iniStagingPairs.empty())
+    {
+        iniStagingPairs = std::move(pairs);
+        return;
+    }
+
+    std::vector<UInt64> merged;
+    merged.reserve(iniStagingPairs.size() + pairs.size());
+    std::set_union(iniStagingPairs.begin(), iniStagingPairs.end(), pairs.begin(), pairs.end(),
+        std::back_inserter(merged));
+    iniStagingPairs.swap(merged);
+}
+
+void KeywordManager::PatchBaseline(const std::vector<UInt64>& added, const std::vector<UInt64>& removed)
+{
+    auto start = std::chrono::steady_clock::now();
+    if (!added.empty() || !removed.empty())
+    {
+        KeywordChangeLog::BeginReset(KeywordAPI::kReset_INI);
+    }
+
+    std::vector<UInt32> formIDs;
+    formIDs.reserve(added.size() + removed.size());
+    for (UInt64 pair : added) formIDs.push_back(static_cast<UInt32>(pair >> 32));
+    for (UInt64 pair : removed) formIDs.push_back(static_cast<UInt32>(pair >> 32));
+    std::sort(formIDs.begin(), formIDs.end());
+    formIDs.erase(std::unique(formIDs.begin(), formIDs.end()), formIDs.end());
+
+    // Only the patched forms' runtime edits depend on the INI keywords
+    // being replaced; every other form is left as it is
+    std::vector<RuntimeEdit> edits;
+    for (UInt32 formID : formIDs)
+    {
+        const KeywordSet* keywords = runtimeKeywords.Find(formID);
+        if (!keywords) continue;
+
+        RuntimeEdit& edit = edits.emplace_back();
+        edit.formID = formID;
+        DiffKeywords(*keywords, baseKeywords.Find(formID), edit.added, edit.removed);
+        DropRuntimeEdit(formID);
+    }
+
+    baseKeywords.Patch(added, removed, keywordNames.size());
+
+    ReapplyEdits(this, edits);
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _MESSAGE("INI baseline: patched %u form(s), +%u/-%u tag(s) in %.1f ms, %u runtime edit(s) re-applied",
+        (UInt32)formIDs.size(), (UInt32)added.size(), (UInt32)removed.size(), ms, (UInt32)edits.size());
+}
+
+bool KeywordManager::HasKeyword(UInt32 formID, std::string_view keyword)
+{
+    UInt32 keywordID = FindKeywordID(keyword);
+    if (keywordID == kInvalidKeywordID) return false;
+
+    return VisitKeywords(formID, [&](const auto& keywords) {
+        return keywords.Contains(keywordID);
+        });
+}
+
+bool KeywordManager::HasKeywordID(UInt32 formID, UInt32 keywordID)
+{
+    if (keywordID == kInvalidKeywordID) return false;
+
+    return VisitKeywords(formID, [&](const auto& keywords) {
+        return keywords.Contains(keywordID);
+        });
+}
+
+UInt32 KeywordManager::BuildKeywordMask(const char* const* keywords, UInt32 count, KeywordMask& outMask) const
 {
-    std::string lowerKeyword = keyword;
-    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+    UInt32 numUnknown = 0;
+    for (UInt32 i = 0; i < count && keywords[i]; ++i)
+    {
+        if (!keywords[i][0]) continue;
 
-    auto it = formKeywords.find(formID);
-    if (it != formKeywords.end())
+        UInt32 keywordID = FindKeywordID(keywords[i]);
+        if (keywordID == kInvalidKeywordID)
+        {
+            ++numUnknown;
+            continue;
+        }
+        outMask.Set(keywordID);
+    }
+    return numUnknown;
+}
+
+UInt32 KeywordManager::BuildKeywordMask(const UInt32* keywordIDs, UInt32 count, KeywordMask& outMask) const
+{
+    UInt32 numUnknown = 0;
+    for (UInt32 i = 0; i < count; ++i)
     {
-        bool found = it->second.find(lowerKeyword) != it->second.end();
-        return found;
+        if (keywordIDs[i] == kInvalidKeywordID) continue;
+
+        if (keywordIDs[i] >= keywordNames.size())
+        {
+            ++numUnknown;
+            continue;
+        }
+        outMask.Set(keywordIDs[i]);
     }
+    return numUnknown;
+}
+
+bool KeywordManager::HasAnyKeyword(UInt32 formID, const KeywordMask& mask)
+{
+    if (mask.Empty()) return false;
+
+    return VisitKeywords(formID, [&](const auto& keywords) {
+        return keywords.ContainsAny(mask);
+        });
+}
+
+bool KeywordManager::HasAllKeywords(UInt32 formID, const KeywordMask& mask)
+{
+    if (mask.Empty()) return true;
+
+    return VisitKeywords(formID, [&](const auto& keywords) {
+        return !keywords.Empty() && keywords.ContainsAll(mask);
+        });
+}
 
-    return false;
+bool KeywordManager::HasKeywordExpr(UInt32 formID, const KeywordExpr& expr)
+{
+    return VisitKeywords(formID, [&](const auto& keywords) {
+        return expr.Evaluate([&](UInt32 keywordID) {
+            return keywords.Contains(keywordID);
+            });
+        });
+}
+
+void KeywordManager::HasKeywordIDs(UInt32 formID, const UInt32* keywordIDs, UInt32 count, UInt8* outResults)
+{
+    VisitKeywords(formID, [&](const auto& keywords) {
+        for (UInt32 i = 0; i < count; ++i)
+        {
+            outResults[i] = keywords.Contains(keywordIDs[i]);
+        }
+        });
+}
+
+// ===== Query planner =====
+
+UInt32 KeywordManager::FindKeywordIDs(const char* const* keywords, UInt32 count, UInt32* outIDs) const
+{
+    UInt32 numUnknown = 0;
+    for (UInt32 i = 0; i < count; ++i)
+    {
+        outIDs[i] = kInvalidKeywordID;
+        if (!keywords[i])
+        {
+            std::fill(outIDs + i, outIDs + count, kInvalidKeywordID);
+            break;
+        }
+        if (!keywords[i][0]) continue;
+
+        outIDs[i] = FindKeywordID(keywords[i]);
+        if (outIDs[i] == kInvalidKeywordID)
+        {
+            ++numUnknown;
+        }
+    }
+    return numUnknown;
+}
+
+UInt32 KeywordManager::PlanKeywordCheck(const UInt32* keywordIDs, UInt32 count, bool matchAll, KeywordCheck& outCheck) const
+{
+    outCheck.count = 0;
+    outCheck.matchAll = matchAll;
+    outCheck.reordered = false;
+
+    UInt32 numUnknown = 0;
+    UInt32 numForms[KeywordCheck::kMaxKeywords];
+    for (UInt32 i = 0; i < count && outCheck.count < KeywordCheck::kMaxKeywords; ++i)
+    {
+        UInt32 keywordID = keywordIDs[i];
+        if (keywordID == kInvalidKeywordID) continue;
+
+        if (keywordID >= keywordNames.size())
+        {
+            ++numUnknown;
+            continue;
+        }
+
+        // Insertion sort on form count; ties keep the caller's order
+        UInt32 forms = CountKeywordForms(keywordID);
+        UInt32 pos = outCheck.count;
+        while (pos > 0 && (matchAll ? forms < numForms[pos - 1] : forms > numForms[pos - 1]))
+        {
+            outCheck.keywordIDs[pos] = outCheck.keywordIDs[pos - 1];
+            numForms[pos] = numForms[pos - 1];
+            --pos;
+        }
+        outCheck.reordered |= pos != outCheck.count;
+        outCheck.keywordIDs[pos] = keywordID;
+        numForms[pos] = forms;
+
+        outCheck.writtenIDs[outCheck.count++] = keywordID;
+    }
+    return numUnknown;
+}
+
+// Tests keywordIDs in order until one decides the result: all-of stops at
+// the first missing keyword, any-of at the first present one.
+template <class Keywords>
+static bool RunKeywordCheck(const Keywords& keywords, const UInt32* keywordIDs, UInt32 count,
+    bool matchAll, UInt32& outComparisons)
+{
+    for (UInt32 i = 0; i < count; ++i)
+    {
+        if (keywords.Contains(keywordIDs[i]) != matchAll)
+        {
+            outComparisons = i + 1;
+            return !matchAll;
+        }
+    }
+    outComparisons = count;
+    return matchAll;
+}
+
+bool KeywordManager::HasKeywords(UInt32 formID, const KeywordCheck& check)
+{
+    if (check.count == 0) return check.matchAll;
+
+    return VisitKeywords(formID, [&](const auto& keywords) {
+        if (keywords.Empty()) return false;
+
+        UInt32 comparisons;
+        bool result = RunKeywordCheck(keywords, check.keywordIDs, check.count, check.matchAll, comparisons);
+
+#if KEYWORDS_PLANNER_STATS
+        UInt32 writtenComparisons = comparisons;
+        if (check.reordered)
+        {
+            RunKeywordCheck(keywords, check.writtenIDs, check.count, check.matchAll, writtenComparisons);
+            ++plannerStats.reorderedChecks;
+        }
+        ++plannerStats.checks;
+        plannerStats.comparisons += comparisons;
+        plannerStats.writtenComparisons += writtenComparisons;
+#endif
+
+        return result;
+        });
 }
 
 std::vector<std::string> KeywordManager::GetKeywords(UInt32 formID)
 {
     std::vector<std::string> result;
-    auto it = formKeywords.find(formID);
-    if (it != formKeywords.end())
+    VisitKeywords(formID, [&](const auto& keywords) {
+        result.reserve(keywords.Size());
+        keywords.ForEach([&](UInt32 keywordID) {
+            result.push_back(keywordNames[keywordID]);
+            });
+        });
+    return result;
+}
+
+UInt32 KeywordManager::GetKeywordIDs(UInt32 formID, UInt32* outIDs, UInt32 capacity)
+{
+    return VisitKeywords(formID, [&](const auto& keywords) {
+        UInt32 count = 0;
+        keywords.ForEach([&](UInt32 keywordID) {
+            if (count < capacity) outIDs[count] = keywordID;
+            ++count;
+            });
+        return count;
+        });
+}
+
+UInt32 KeywordManager::GetKeywordNames(UInt32 formID, const char** outNames, UInt32 capacity)
+{
+    return VisitKeywords(formID, [&](const auto& keywords) {
+        UInt32 count = 0;
+        keywords.ForEach([&](UInt32 keywordID) {
+            if (count < capacity) outNames[count] = keywordNames[keywordID].c_str();
+            ++count;
+            });
+        return count;
+        });
+}
+
+const char* KeywordManager::GetNthKeyword(UInt32 formID, UInt32 index)
+{
+    return VisitKeywords(formID, [&](const auto& keywords) {
+        const char* name = "";
+        UInt32 i = 0;
+        keywords.ForEach([&](UInt32 keywordID) {
+            if (i++ == index) name = keywordNames[keywordID].c_str();
+            });
+        return name;
+        });
+}
+
+std::vector<UInt32> KeywordManager::GetFormsWithKeyword(std::string_view keyword)
+{
+    std::vector<UInt32> result;
+    UInt32 keywordID = FindKeywordID(keyword);
+    if (keywordID != kInvalidKeywordID)
     {
-        result.assign(it->second.begin(), it->second.end());
+        CollectKeywordForms(keywordID, result);
     }
     return result;
 }
 
-std::vector<UInt32> KeywordManager::GetFormsWithKeyword(const std::string& keyword)
+// ===== Form queries =====
+//
+// Evaluates a keyword expression over the reverse index instead of per form.
+// Each subexpression yields a sorted form ID list, or the complement of one
+// when it is negated, so "A & !B" is a difference rather than a scan of every
+// form.  Conjunctions intersect starting from the smallest list.
+
+namespace
 {
-    std::vector<UInt32> result;
-    std::string lowerKeyword = keyword;
-    std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+    struct FormQueryOperand
+    {
+        const UInt32*       data = nullptr;
+        UInt32              size = 0;
+        bool                negated = false;
+        std::vector<UInt32> owned;      // backing storage for computed results
+
+        void Own(std::vector<UInt32>&& formIDs)
+        {
+            owned = std::move(formIDs);
+            data = owned.data();
+            size = owned.size();
+        }
+    };
+}
 
-    auto it = keywordForms.find(lowerKeyword);
-    if (it != keywordForms.end())
+// leafForms(keywordID, operand) sets operand to the keyword's sorted form list
+template <class LeafFunc>
+static FormQueryOperand EvaluateFormQuery(const std::vector<KeywordExpr::Node>& nodes, UInt32 index,
+    LeafFunc& leafForms)
+{
+    const KeywordExpr::Node& node = nodes[index];
+    FormQueryOperand result;
+
+    switch (node.op)
+    {
+    case KeywordExpr::kOp_Keyword:
+        leafForms(node.arg, result);
+        return result;
+
+    case KeywordExpr::kOp_Not:
+        result = EvaluateFormQuery(nodes, index + 1, leafForms);
+        result.negated = !result.negated;
+        return result;
+
+    case KeywordExpr::kOp_And:
+    case KeywordExpr::kOp_Or:
+        break;
+    }
+
+    std::vector<FormQueryOperand> positive, negative;
+    UInt32 child = index + 1;
+    for (UInt32 i = 0; i < node.arg; ++i)
+    {
+        FormQueryOperand operand = EvaluateFormQuery(nodes, child, leafForms);
+        (operand.negated ? negative : positive).push_back(std::move(operand));
+        child += nodes[child].size;
+    }
+
+    auto bySize = [](const FormQueryOperand& a, const FormQueryOperand& b) { return a.size < b.size; };
+    std::sort(positive.begin(), positive.end(), bySize);
+    std::sort(negative.begin(), negative.end(), bySize);
+
+    // And: intersect the positives, subtract the negatives.
+    // Or:  by De Morgan, !(intersect the negatives, subtract the positives).
+    // With no sets to intersect, And becomes !(union of negatives) and Or a union.
+    bool isAnd = node.op == KeywordExpr::kOp_And;
+    auto& intersect = isAnd ? positive : negative;
+    auto& subtract = isAnd ? negative : positive;
+
+    std::vector<UInt32> formIDs;
+    if (!intersect.empty())
+    {
+        formIDs.assign(intersect[0].data, intersect[0].data + intersect[0].size);
+        for (size_t i = 1; i < intersect.size() && !formIDs.empty(); ++i)
+        {
+            PostingOps::IntersectInto(formIDs, intersect[i].data, intersect[i].size);
+        }
+        for (size_t i = 0; i < subtract.size() && !formIDs.empty(); ++i)
+        {
+            PostingOps::SubtractInto(formIDs, subtract[i].data, subtract[i].size);
+        }
+        result.negated = !isAnd;
+    }
+    else
     {
-        result.assign(it->second.begin(), it->second.end());
+        for (const auto& operand : subtract)
+        {
+            PostingOps::UnionInto(formIDs, operand.data, operand.size);
+        }
+        result.negated = isAnd;
     }
+
+    result.Own(std::move(formIDs));
     return result;
 }
 
-int KeywordManager::GetKeywordCount(UInt32 formID)
+bool KeywordManager::FindForms(const KeywordExpr& expr, std::vector<UInt32>& outFormIDs)
 {
-    auto it = formKeywords.find(formID);
-    if (it != formKeywords.end())
+    outFormIDs.clear();
+    if (!expr.IsValid()) return false;
+
+    auto leafForms = [this](UInt32 keywordID, FormQueryOperand& operand) {
+        UInt32 baseCount;
+        const UInt32* base = baseKeywords.GetForms(keywordID, baseCount);
+        const auto& runtime = runtimeForms[keywordID].Get();
+
+        // Keywords untouched at runtime point straight into the index
+        if (shadowedForms[keywordID].Size() == 0 && (runtime.empty() || baseCount == 0))
+        {
+            operand.data = baseCount ? base : runtime.data();
+            operand.size = baseCount ? baseCount : runtime.size();
+            return;
+        }
+
+        std::vector<UInt32> formIDs;
+        CollectKeywordForms(keywordID, formIDs);
+        operand.Own(std::move(formIDs));
+        };
+
+    FormQueryOperand result = EvaluateFormQuery(expr.GetNodes(), 0, leafForms);
+    if (result.negated)
     {
-        return it->second.size();
+        // Complement relative to every form that has at least one keyword
+        outFormIDs = GetTaggedForms();
+        PostingOps::SubtractInto(outFormIDs, result.data, result.size);
     }
-    return 0;
+    else
+    {
+        outFormIDs.assign(result.data, result.data + result.size);
+    }
+    return true;
+}
+
+int KeywordManager::GetKeywordCount(UInt32 formID)
+{
+    return VisitKeywords(formID, [](const auto& keywords) {
+        return static_cast<int>(keywords.Size());
+        });
 }
 
 void KeywordManager::ClearFormKeywords(UInt32 formID)
 {
-    auto it = formKeywords.find(formID);
-    if (it != formKeywords.end())
+    if (!GetKeywordCount(formID)) return;
+
+    KeywordSet& keywords = EditKeywords(formID);
+
+    // Remove from reverse index
+    keywords.ForEach([&](UInt32 keywordID) {
+        runtimeForms[keywordID].Remove(formID);
+        KeywordChangeLog::Record(formID, keywordID, true);
+        });
+
+    // An empty runtime entry hides the form's INI keywords
+    if (!baseKeywords.Find(formID).Empty())
     {
-        // Remove from reverse index
-        for (const auto& keyword : it->second)
-        {
-            auto keyIt = keywordForms.find(keyword);
-            if (keyIt != keywordForms.end())
-            {
-                keyIt->second.erase(formID);
-                if (keyIt->second.empty())
-                {
-                    keywordForms.erase(keyIt);
-                }
-            }
-        }
-        formKeywords.erase(it);
+        keywords = KeywordSet();
+    }
+    else
+    {
+        runtimeKeywords.Erase(formID);
+    }
+}
+
+void KeywordManager::ClearRuntimeKeywords()
+{
+    runtimeKeywords.Clear();
+    for (auto& forms : runtimeForms)
+    {
+        forms.Clear();
+    }
+    for (auto& forms : shadowedForms)
+    {
+        forms.Clear();
     }
 }
 
 void KeywordManager::ClearAllKeywords()
 {
-    formKeywords.clear();
-    keywordForms.clear();
+    ClearRuntimeKeywords();
+    baseKeywords.Clear();
+    iniStaging.Clear();
+    std::vector<UInt64>().swap(iniStagingPairs);
+
+    // The intern table is kept so that keyword IDs stay stable for the session
+}
+
+// ===== Diagnostics =====
+
+KeywordMemoryStats KeywordManager::GetMemoryStats() const
+{
+    KeywordMemoryStats stats;
+    stats.numKeywords = keywordNames.size() - 1;
+    stats.formTableBytes = runtimeKeywords.TableBytes();
+    stats.frozenBytes = baseKeywords.Bytes();
+    stats.numRuntimeForms = runtimeKeywords.Size();
+
+    baseKeywords.ForEach([&](UInt32 formID, KeywordSpan keywords) {
+        if (runtimeKeywords.Find(formID)) return;
+
+        ++stats.numForms;
+        ++stats.numFrozenForms;
+        stats.numTags += keywords.Size();
+        });
+
+    runtimeKeywords.ForEach([&](UInt32, const KeywordSet& keywords) {
+        stats.spilledBytes += keywords.HeapBytes();
+        if (keywords.Empty()) return;
+
+        ++stats.numForms;
+        stats.numTags += keywords.Size();
+        if (keywords.IsInline())
+        {
+            ++stats.numInlineForms;
+        }
+        });
+
+    return stats;
+}
+
+void KeywordManager::LogMemoryStats() const
+{
+    KeywordMemoryStats stats = GetMemoryStats();
+    _MESSAGE("Keywords: %u forms (%u frozen, %u inline, %u spilled), %u tags, %u keywords; "
+        "frozen index %u KB, table %u KB, spilled %u KB",
+        stats.numForms, stats.numFrozenForms, stats.numInlineForms,
+        stats.numForms - stats.numFrozenForms - stats.numInlineForms,
+        stats.numTags, stats.numKeywords,
+        stats.frozenBytes / 1024, stats.formTableBytes / 1024, stats.spilledBytes / 1024);
 }
 
 // ===== Serialization =====
+//
+// INI keywords are read from the INI files each session, so a save only holds
+// the runtime layer: for each form edited by scripts or other plugins, the
+// keywords it gained and the INI keywords it lost.  Everything goes into one
+// KWPK record:
+//
+//     varint numKeywords, then numKeywords strings   (keyword table)
+//     varint numForms, then per form, ascending by form ID:
+//         varint formID - previous formID
+//         varint numAdded, then that many varint keyword table indices
+//         varint numRemoved, then that many varint keyword table indices
+//
+// Only keywords in use are written, numbered in order of first use.
+//
+// Older saves hold every keyword instead, and Load adds them all on top of
+// the INI keywords: version 2 of KWPK has a single keyword list per form, and
+// version 1 wrote a KWCT count, then per form a KWFM + KWKC record and a
+// KWKL + KWKD record pair per keyword.
+
+namespace
+{
+    const UInt32 kFullSaveVersion = 2;
+    const UInt32 kDeltaSaveVersion = 3;
+
+    // Sanity limits for values read from a save, so corrupt data cannot
+    // trigger huge allocations
+    const UInt32 kMaxSavedKeywordLength = 4096;
+    const UInt32 kMaxReservedForms = 1 << 20;
+
+    bool ReadUInt32Record(OBSESerializationInterface* intfc, UInt32 length, UInt32& outValue)
+    {
+        return length == sizeof(outValue)
+            && intfc->ReadRecordData(&outValue, sizeof(outValue)) == sizeof(outValue);
+    }
+
+    // Reads the current record's payload, reusing buffer's storage
+    bool ReadRecordPayload(OBSESerializationInterface* intfc, UInt32 length, std::vector<UInt8>& buffer)
+    {
+        buffer.resize(length);
+        return intfc->ReadRecordData(buffer.data(), length) == length;
+    }
+
+    std::string_view AsString(const std::vector<UInt8>& buffer)
+    {
+        return std::string_view(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    }
+}
 
 void KeywordManager::Save(OBSESerializationInterface* intfc)
 {
-    // Write number of forms with keywords
-    UInt32 numForms = formKeywords.size();
-    intfc->WriteRecord('KWCT', 1, &numForms, sizeof(numForms));
+    // Keyword ID -> table index + 1, or 0 while not yet written
+    std::vector<UInt32> tableIndex(keywordNames.size(), 0);
+    std::vector<UInt32> tableKeywords;
+
+    auto writeKeywordList = [&](ByteWriter& out, const std::vector<UInt32>& keywordIDs) {
+        out.WriteVarint(keywordIDs.size());
+        for (UInt32 keywordID : keywordIDs)
+        {
+            UInt32& index = tableIndex[keywordID];
+            if (!index)
+            {
+                tableKeywords.push_back(keywordID);
+                index = tableKeywords.size();
+            }
+            out.WriteVarint(index - 1);
+        }
+        };
+
+    std::vector<UInt32> added, removed;
+    ByteWriter forms;
+    UInt32 numForms = 0;
+    UInt32 prevFormID = 0;
+
+    for (UInt32 formID : runtimeKeywords.SortedKeys())
+    {
+        DiffKeywords(*runtimeKeywords.Find(formID), baseKeywords.Find(formID), added, removed);
+        if (added.empty() && removed.empty())
+        {
+            // Edited back to its INI state
+            DropRuntimeEdit(formID);
+            continue;
+        }
+
+        forms.WriteVarint(formID - prevFormID);
+        writeKeywordList(forms, added);
+        writeKeywordList(forms, removed);
+        prevFormID = formID;
+        ++numForms;
+    }
+
+    // The keyword table is only complete once the forms are written, so the
+    // record is assembled from two buffers
+    ByteWriter table;
+    table.WriteVarint(tableKeywords.size());
+    for (UInt32 keywordID : tableKeywords)
+    {
+        table.WriteString(keywordNames[keywordID]);
+    }
+    table.WriteVarint(numForms);
+
+    intfc->OpenRecord('KWPK', kDeltaSaveVersion);
+    intfc->WriteRecordData(table.Data(), table.Size());
+    intfc->WriteRecordData(forms.Data(), forms.Size());
+
+    _MESSAGE("Saved runtime keyword changes for %u forms, %u keywords (%u bytes)",
+        numForms, tableKeywords.size(), table.Size() + forms.Size());
+}
+
+void KeywordManager::LoadPackedRecord(OBSESerializationInterface* intfc, UInt32 version, UInt32 length,
+    std::vector<UInt8>& buffer, std::vector<UInt32>& formKeywordIDs)
+{
+    if (version != kFullSaveVersion && version != kDeltaSaveVersion)
+    {
+        _WARNING("Skipping keyword record version %u (expected %u)", version, kDeltaSaveVersion);
+        return;
+    }
+
+    if (!ReadRecordPayload(intfc, length, buffer))
+    {
+        _WARNING("Keyword record truncated, skipping it");
+        return;
+    }
+
+    ByteReader reader(buffer.data(), length);
+
+    // Every entry takes at least one byte, which bounds the counts below
+    // even if the record is corrupt
+    UInt32 numKeywords = reader.ReadVarint();
+    if (numKeywords > reader.Remaining())
+    {
+        reader.Fail();
+    }
+
+    std::vector<UInt32> keywordIDs;
+    keywordIDs.reserve(reader.Ok() ? numKeywords : 0);
+    for (UInt32 i = 0; i < numKeywords && reader.Ok(); ++i)
+    {
+        keywordIDs.push_back(InternKeyword(reader.ReadString()));
+    }
+
+    // Reads a count and that many keyword table indices into formKeywordIDs
+    auto readKeywordList = [&]() {
+        formKeywordIDs.clear();
+
+        UInt32 count = reader.ReadVarint();
+        if (count > reader.Remaining())
+        {
+            reader.Fail();
+            return;
+        }
+
+        for (UInt32 i = 0; i < count && reader.Ok(); ++i)
+        {
+            UInt32 index = reader.ReadVarint();
+            if (index >= keywordIDs.size())
+            {
+                reader.Fail();
+                return;
+            }
+            formKeywordIDs.push_back(keywordIDs[index]);
+        }
+        };
+
+    UInt32 numForms = reader.ReadVarint();
+    if (numForms > reader.Remaining())
+    {
+        reader.Fail();
+    }
+    if (reader.Ok() && version == kFullSaveVersion)
+    {
+        runtimeKeywords.Reserve(runtimeKeywords.Size() + std::min(numForms, kMaxReservedForms));
+    }
 
-    // Write each form's keywords
-    for (const auto& pair : formKeywords)
+    UInt32 oldFormID = 0;
+    for (UInt32 i = 0; i < numForms && reader.Ok(); ++i)
     {
-        UInt32 formID = pair.first;
-        UInt32 numKeywords = pair.second.size();
+        oldFormID += reader.ReadVarint();
+
+        // Resolve form ID in case of mod changes
+        UInt32 newFormID;
+        if (!intfc->ResolveRefID(oldFormID, &newFormID))
+        {
+            newFormID = oldFormID;
+        }
 
-        intfc->WriteRecord('KWFM', 1, &formID, sizeof(formID));
-        intfc->WriteRecord('KWKC', 1, &numKeywords, sizeof(numKeywords));
+        readKeywordList();
+        if (!reader.Ok()) break;
+        AddKeywordIDs(newFormID, formKeywordIDs.data(), formKeywordIDs.size());
 
-        for (const auto& keyword : pair.second)
+        if (version == kDeltaSaveVersion)
         {
-            UInt32 keywordLen = keyword.length();
-            intfc->WriteRecord('KWKL', 1, &keywordLen, sizeof(keywordLen));
-            intfc->WriteRecord('KWKD', 1, keyword.c_str(), keywordLen);
+            readKeywordList();
+            if (!reader.Ok()) break;
+            for (UInt32 keywordID : formKeywordIDs)
+            {
+                RemoveKeywordID(newFormID, keywordID);
+            }
         }
     }
+
+    if (!reader.Ok() || !reader.AtEnd())
+    {
+        _WARNING("Keyword record is corrupt; loaded what could be read");
+    }
 }
 
 void KeywordManager::Load(OBSESerializationInterface* intfc)
 {
-    ClearAllKeywords();
+    KeywordChangeLog::BeginReset(KeywordAPI::kReset_Game);
+
+    // Scratch storage shared by every record, so loading does not allocate
+    // per keyword
+    std::vector<UInt8> buffer;
+    std::vector<UInt32> formKeywordIDs;
 
     UInt32 type, version, length;
 
@@ -173,17 +1099,25 @@ void KeywordManager::Load(OBSESerializationInterface* intfc)
     {
         switch (type)
         {
+        case 'KWPK':
+            LoadPackedRecord(intfc, version, length, buffer, formKeywordIDs);
+            break;
+
+        // Version 1 records
         case 'KWCT':
         {
             UInt32 numForms;
-            intfc->ReadRecordData(&numForms, sizeof(numForms));
+            if (ReadUInt32Record(intfc, length, numForms))
+            {
+                runtimeKeywords.Reserve(runtimeKeywords.Size() + std::min(numForms, kMaxReservedForms));
+            }
             break;
         }
 
         case 'KWFM':
         {
             UInt32 oldFormID, newFormID;
-            intfc->ReadRecordData(&oldFormID, sizeof(oldFormID));
+            if (!ReadUInt32Record(intfc, length, oldFormID)) break;
 
             // Resolve form ID in case of mod changes
             if (!intfc->ResolveRefID(oldFormID, &newFormID))
@@ -192,33 +1126,41 @@ void KeywordManager::Load(OBSESerializationInterface* intfc)
             }
 
             // Read keyword count
-            if (intfc->GetNextRecordInfo(&type, &version, &length) && type == 'KWKC')
+            UInt32 numKeywords;
+            if (!intfc->GetNextRecordInfo(&type, &version, &length) || type != 'KWKC'
+                || !ReadUInt32Record(intfc, length, numKeywords))
+            {
+                break;
+            }
+
+            // Read each keyword as a KWKL length + KWKD string pair
+            formKeywordIDs.clear();
+            for (UInt32 i = 0; i < numKeywords; i++)
             {
-                UInt32 numKeywords;
-                intfc->ReadRecordData(&numKeywords, sizeof(numKeywords));
+                UInt32 keywordLen;
+                if (!intfc->GetNextRecordInfo(&type, &version, &length) || type != 'KWKL'
+                    || !ReadUInt32Record(intfc, length, keywordLen))
+                {
+                    break;
+                }
+                if (!intfc->GetNextRecordInfo(&type, &version, &length) || type != 'KWKD')
+                {
+                    break;
+                }
 
-                // Read each keyword
-                for (UInt32 i = 0; i < numKeywords; i++)
+                // The KWKD record length is what the co-save actually holds,
+                // so a corrupt KWKL value is rejected rather than trusted
+                if (keywordLen != length || length > kMaxSavedKeywordLength
+                    || !ReadRecordPayload(intfc, length, buffer))
                 {
-                    if (intfc->GetNextRecordInfo(&type, &version, &length) && type == 'KWKL')
-                    {
-                        UInt32 keywordLen;
-                        intfc->ReadRecordData(&keywordLen, sizeof(keywordLen));
-
-                        if (intfc->GetNextRecordInfo(&type, &version, &length) && type == 'KWKD')
-                        {
-                            char* buffer = new char[keywordLen + 1];
-                            intfc->ReadRecordData(buffer, keywordLen);
-                            buffer[keywordLen] = '\0';
-
-                            std::string keyword(buffer);
-                            AddKeyword(newFormID, keyword);
-
-                            delete[] buffer;
-                        }
-                    }
+                    _WARNING("Skipping corrupt keyword record for form %08X", oldFormID);
+                    continue;
                 }
+
+                formKeywordIDs.push_back(InternKeyword(AsString(buffer)));
             }
+
+            AddKeywordIDs(newFormID, formKeywordIDs.data(), formKeywordIDs.size());
             break;
         }
         }
@@ -227,7 +1169,8 @@ void KeywordManager::Load(OBSESerializationInterface* intfc)
 
 void KeywordManager::NewGame()
 {
-    ClearAllKeywords();
+    KeywordChangeLog::BeginReset(KeywordAPI::kReset_Game);
+    ClearRuntimeKeywords();
 }
 
 
@@ -377,16 +1320,277 @@ bool Cmd_GetKeywordCount_Execute(COMMAND_ARGS)
         return true;
     }
 
-    *result = KeywordManager::GetSingleton()->GetKeywordCount(form->refID);
+    *result = KeywordManager::GetSingleton()->GetKeywordCount(form->refID);
+
+    return true;
+}
+
+bool Cmd_GetKeywordCountRef_Execute(COMMAND_ARGS)
+{
+    *result = 0;
+
+    TESObjectREFR* form = nullptr;
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form))
+    {
+        return true;
+    }
+
+    if (!form)
+    {
+        return true;
+    }
+
+    *result = KeywordManager::GetSingleton()->GetKeywordCount(form->refID);
+
+    return true;
+}
+
+bool Cmd_ClearKeywords_Execute(COMMAND_ARGS)
+{
+    *result = 0;
+
+    TESForm* form = nullptr;
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form))
+    {
+        return true;
+    }
+
+    if (!form)
+    {
+        return true;
+    }
+
+    KeywordManager::GetSingleton()->ClearFormKeywords(form->refID);
+    *result = 1;
+
+    return true;
+}
+
+bool Cmd_ClearKeywordsRef_Execute(COMMAND_ARGS)
+{
+    *result = 0;
+
+    TESObjectREFR* form = nullptr;
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form))
+    {
+        return true;
+    }
+
+    if (!form)
+    {
+        return true;
+    }
+
+    KeywordManager::GetSingleton()->ClearFormKeywords(form->refID);
+    *result = 1;
+
+    return true;
+}
+
+bool Cmd_GetNthKeyword_Execute(COMMAND_ARGS)
+{
+    const char* resultStr = "";
+
+    TESForm* form = nullptr;
+    UInt32 index = 0;
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &index))
+    {
+        AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
+        return true;
+    }
+
+    if (!form)
+    {
+        AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
+        return true;
+    }
+
+    resultStr = KeywordManager::GetSingleton()->GetNthKeyword(form->refID, index);
+
+    AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
+    return true;
+}
+
+bool Cmd_GetNthKeywordRef_Execute(COMMAND_ARGS)
+{
+    const char* resultStr = "";
+
+    TESForm* form = nullptr;
+    UInt32 index = 0;
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &index))
+    {
+        AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
+        return true;
+    }
+
+    if (!form)
+    {
+        AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
+        return true;
+    }
+
+    resultStr = KeywordManager::GetSingleton()->GetNthKeyword(form->refID, index);
+
+    AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
+    return true;
+}
+
+bool Cmd_HasAnyKeyword_Execute(COMMAND_ARGS)
+{
+    *result = 0;
+
+    TESForm* form = nullptr;
+    char keyword1[512] = "";
+    char keyword2[512] = "";
+    char keyword3[512] = "";
+    char keyword4[512] = "";
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &keyword1, &keyword2, &keyword3, &keyword4))
+    {
+        return true;
+    }
+
+    if (!form)
+    {
+        return true;
+    }
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+
+    const char* keywords[] = { keyword1, keyword2, keyword3, keyword4 };
+    UInt32 keywordIDs[4];
+    mgr->FindKeywordIDs(keywords, 4, keywordIDs);
+
+    KeywordCheck check;
+    mgr->PlanKeywordCheck(keywordIDs, 4, false, check);
+
+    if (mgr->HasKeywords(form->refID, check))
+    {
+        *result = 1;
+    }
+
+    return true;
+}
+
+bool Cmd_HasAnyKeywordRef_Execute(COMMAND_ARGS)
+{
+    *result = 0;
+
+    TESObjectREFR* form = nullptr;
+    char keyword1[512] = "";
+    char keyword2[512] = "";
+    char keyword3[512] = "";
+    char keyword4[512] = "";
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &keyword1, &keyword2, &keyword3, &keyword4))
+    {
+        return true;
+    }
+
+    if (!form)
+    {
+        return true;
+    }
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+
+    const char* keywords[] = { keyword1, keyword2, keyword3, keyword4 };
+    UInt32 keywordIDs[4];
+    mgr->FindKeywordIDs(keywords, 4, keywordIDs);
+
+    KeywordCheck check;
+    mgr->PlanKeywordCheck(keywordIDs, 4, false, check);
+
+    if (mgr->HasKeywords(form->refID, check))
+    {
+        *result = 1;
+    }
+
+    return true;
+}
+
+bool Cmd_HasAllKeywords_Execute(COMMAND_ARGS)
+{
+    *result = 0;
+
+    TESForm* form = nullptr;
+    char keyword1[512] = "";
+    char keyword2[512] = "";
+    char keyword3[512] = "";
+    char keyword4[512] = "";
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &keyword1, &keyword2, &keyword3, &keyword4))
+    {
+        return true;
+    }
+
+    if (!form)
+    {
+        return true;
+    }
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+
+    const char* keywords[] = { keyword1, keyword2, keyword3, keyword4 };
+    // A keyword that was never interned cannot be on the form
+    UInt32 keywordIDs[4];
+    KeywordCheck check;
+    if (mgr->FindKeywordIDs(keywords, 4, keywordIDs) == 0
+        && mgr->PlanKeywordCheck(keywordIDs, 4, true, check) == 0
+        && mgr->HasKeywords(form->refID, check))
+    {
+        *result = 1;
+    }
+
+    return true;
+}
+
+bool Cmd_HasAllKeywordsRef_Execute(COMMAND_ARGS)
+{
+    *result = 0;
+
+    TESObjectREFR* form = nullptr;
+    char keyword1[512] = "";
+    char keyword2[512] = "";
+    char keyword3[512] = "";
+    char keyword4[512] = "";
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &keyword1, &keyword2, &keyword3, &keyword4))
+    {
+        return true;
+    }
+
+    if (!form)
+    {
+        return true;
+    }
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+
+    const char* keywords[] = { keyword1, keyword2, keyword3, keyword4 };
+    // A keyword that was never interned cannot be on the form
+    UInt32 keywordIDs[4];
+    KeywordCheck check;
+    if (mgr->FindKeywordIDs(keywords, 4, keywordIDs) == 0
+        && mgr->PlanKeywordCheck(keywordIDs, 4, true, check) == 0
+        && mgr->HasKeywords(form->refID, check))
+    {
+        *result = 1;
+    }
 
     return true;
 }
 
-bool Cmd_GetKeywordCountRef_Execute(COMMAND_ARGS)
+bool Cmd_PrintKeywords_Execute(COMMAND_ARGS)
 {
     *result = 0;
 
-    TESObjectREFR* form = nullptr;
+    TESForm* form = nullptr;
 
     if (!ExtractArgs(PASS_EXTRACT_ARGS, &form))
     {
@@ -398,16 +1602,30 @@ bool Cmd_GetKeywordCountRef_Execute(COMMAND_ARGS)
         return true;
     }
 
-    *result = KeywordManager::GetSingleton()->GetKeywordCount(form->refID);
+    auto keywords = KeywordManager::GetSingleton()->GetKeywords(form->refID);
+
+    Console_Print("Keywords for form %08X:", form->refID);
+    if (keywords.empty())
+    {
+        Console_Print("  (none)");
+    }
+    else
+    {
+        for (const auto& keyword : keywords)
+        {
+            Console_Print("  %s", keyword.c_str());
+        }
+    }
 
+    *result = keywords.size();
     return true;
 }
 
-bool Cmd_ClearKeywords_Execute(COMMAND_ARGS)
+bool Cmd_PrintKeywordsRef_Execute(COMMAND_ARGS)
 {
     *result = 0;
 
-    TESForm* form = nullptr;
+    TESObjectREFR* form = nullptr;
 
     if (!ExtractArgs(PASS_EXTRACT_ARGS, &form))
     {
@@ -419,103 +1637,133 @@ bool Cmd_ClearKeywords_Execute(COMMAND_ARGS)
         return true;
     }
 
-    KeywordManager::GetSingleton()->ClearFormKeywords(form->refID);
-    *result = 1;
+    auto keywords = KeywordManager::GetSingleton()->GetKeywords(form->refID);
+
+    Console_Print("Keywords for form %08X:", form->refID);
+    if (keywords.empty())
+    {
+        Console_Print("  (none)");
+    }
+    else
+    {
+        for (const auto& keyword : keywords)
+        {
+            Console_Print("  %s", keyword.c_str());
+        }
+    }
 
+    *result = keywords.size();
     return true;
 }
 
-bool Cmd_ClearKeywordsRef_Execute(COMMAND_ARGS)
+// PrintKeywordStats
+// Prints keyword table sizes and memory use to the console.
+bool Cmd_PrintKeywordStats_Execute(COMMAND_ARGS)
 {
-    *result = 0;
-
-    TESObjectREFR* form = nullptr;
+    KeywordMemoryStats stats = KeywordManager::GetSingleton()->GetMemoryStats();
+
+    Console_Print("Keyword forms: %u (%u frozen, %u inline, %u spilled)",
+        stats.numForms, stats.numFrozenForms, stats.numInlineForms,
+        stats.numForms - stats.numFrozenForms - stats.numInlineForms);
+    Console_Print("Keyword tags: %u, distinct keywords: %u", stats.numTags, stats.numKeywords);
+    Console_Print("Forms edited at runtime: %u", stats.numRuntimeForms);
+    Console_Print("Frozen INI index: %u KB, form table: %u KB, spilled storage: %u KB",
+        stats.frozenBytes / 1024, stats.formTableBytes / 1024, stats.spilledBytes / 1024);
+
+#if KEYWORDS_PLANNER_STATS
+    const KeywordPlannerStats& planner = KeywordManager::GetSingleton()->GetPlannerStats();
+    Console_Print("Query planner: %llu of %llu checks reordered, %llu keyword lookups (%lld saved)",
+        planner.reorderedChecks, planner.checks, planner.comparisons,
+        static_cast<SInt64>(planner.writtenComparisons - planner.comparisons));
+#endif
+
+    *result = stats.numForms;
+    return true;
+}
 
-    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form))
+// ===== Keyword handles =====
+//
+// GetKeywordHandle interns a keyword once and returns its script handle.
+// Scripts can cache the handle and pass it to the *H commands, which
+// skip string extraction and lookup entirely.  Handles are derived from
+// the keyword's name, so handles kept in a save still work after the
+// game is restarted.
+
+// Resolves script handles to keyword IDs in place.  Returns how many
+// nonzero handles name no keyword (never interned in this session, or
+// shared by two keywords).
+static UInt32 ResolveScriptHandles(KeywordManager* mgr, UInt32* handles, UInt32 count)
+{
+    UInt32 numUnknown = 0;
+    for (UInt32 i = 0; i < count; ++i)
     {
-        return true;
-    }
+        if (handles[i] == 0) continue;
 
-    if (!form)
-    {
-        return true;
+        handles[i] = mgr->ResolveScriptHandle(handles[i]);
+        if (handles[i] == kInvalidKeywordID) ++numUnknown;
     }
+    return numUnknown;
+}
 
-    KeywordManager::GetSingleton()->ClearFormKeywords(form->refID);
-    *result = 1;
+bool Cmd_GetKeywordHandle_Execute(COMMAND_ARGS)
+{
+    *result = 0;
+    char keyword[512] = { 0 };
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, keyword))
+        return true;
 
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    *result = mgr->GetScriptHandle(mgr->InternKeyword(keyword));
     return true;
 }
 
-bool Cmd_GetNthKeyword_Execute(COMMAND_ARGS)
+bool Cmd_HasKeywordH_Execute(COMMAND_ARGS)
 {
-    const char* resultStr = "";
-
+    *result = 0;
     TESForm* form = nullptr;
-    UInt32 index = 0;
+    UInt32 handle = 0;
 
-    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &index))
-    {
-        AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &handle))
         return true;
-    }
 
     if (!form)
-    {
-        AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
         return true;
-    }
 
-    auto keywords = KeywordManager::GetSingleton()->GetKeywords(form->refID);
-    if (index < keywords.size())
-    {
-        resultStr = keywords[index].c_str();
-    }
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    if (mgr->HasKeywordID(form->refID, mgr->ResolveScriptHandle(handle)))
+        *result = 1;
 
-    AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
     return true;
 }
 
-bool Cmd_GetNthKeywordRef_Execute(COMMAND_ARGS)
+bool Cmd_HasKeywordHRef_Execute(COMMAND_ARGS)
 {
-    const char* resultStr = "";
-
-    TESForm* form = nullptr;
-    UInt32 index = 0;
+    *result = 0;
+    TESObjectREFR* form = nullptr;
+    UInt32 handle = 0;
 
-    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &index))
-    {
-        AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &handle))
         return true;
-    }
 
     if (!form)
-    {
-        AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
         return true;
-    }
 
-    auto keywords = KeywordManager::GetSingleton()->GetKeywords(form->refID);
-    if (index < keywords.size())
-    {
-        resultStr = keywords[index].c_str();
-    }
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    if (mgr->HasKeywordID(form->refID, mgr->ResolveScriptHandle(handle)))
+        *result = 1;
 
-    AssignToStringVar(PASS_COMMAND_ARGS, resultStr);
     return true;
 }
 
-bool Cmd_HasAnyKeyword_Execute(COMMAND_ARGS)
+bool Cmd_HasAnyKeywordH_Execute(COMMAND_ARGS)
 {
     *result = 0;
 
     TESForm* form = nullptr;
-    char keyword1[512] = "";
-    char keyword2[512] = "";
-    char keyword3[512] = "";
-    char keyword4[512] = "";
+    UInt32 handles[4] = { 0 };
 
-    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &keyword1, &keyword2, &keyword3, &keyword4))
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &handles[0], &handles[1], &handles[2], &handles[3]))
     {
         return true;
     }
@@ -527,41 +1775,27 @@ bool Cmd_HasAnyKeyword_Execute(COMMAND_ARGS)
 
     KeywordManager* mgr = KeywordManager::GetSingleton();
 
-    if (keyword1[0] && mgr->HasKeyword(form->refID, keyword1))
-    {
-        *result = 1;
-        return true;
-    }
-    if (keyword2[0] && mgr->HasKeyword(form->refID, keyword2))
-    {
-        *result = 1;
-        return true;
-    }
-    if (keyword3[0] && mgr->HasKeyword(form->refID, keyword3))
-    {
-        *result = 1;
-        return true;
-    }
-    if (keyword4[0] && mgr->HasKeyword(form->refID, keyword4))
+    ResolveScriptHandles(mgr, handles, 4);
+
+    KeywordCheck check;
+    mgr->PlanKeywordCheck(handles, 4, false, check);
+
+    if (mgr->HasKeywords(form->refID, check))
     {
         *result = 1;
-        return true;
     }
 
     return true;
 }
 
-bool Cmd_HasAnyKeywordRef_Execute(COMMAND_ARGS)
+bool Cmd_HasAnyKeywordHRef_Execute(COMMAND_ARGS)
 {
     *result = 0;
 
     TESObjectREFR* form = nullptr;
-    char keyword1[512] = "";
-    char keyword2[512] = "";
-    char keyword3[512] = "";
-    char keyword4[512] = "";
+    UInt32 handles[4] = { 0 };
 
-    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &keyword1, &keyword2, &keyword3, &keyword4))
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &handles[0], &handles[1], &handles[2], &handles[3]))
     {
         return true;
     }
@@ -573,41 +1807,27 @@ bool Cmd_HasAnyKeywordRef_Execute(COMMAND_ARGS)
 
     KeywordManager* mgr = KeywordManager::GetSingleton();
 
-    if (keyword1[0] && mgr->HasKeyword(form->refID, keyword1))
-    {
-        *result = 1;
-        return true;
-    }
-    if (keyword2[0] && mgr->HasKeyword(form->refID, keyword2))
-    {
-        *result = 1;
-        return true;
-    }
-    if (keyword3[0] && mgr->HasKeyword(form->refID, keyword3))
-    {
-        *result = 1;
-        return true;
-    }
-    if (keyword4[0] && mgr->HasKeyword(form->refID, keyword4))
+    ResolveScriptHandles(mgr, handles, 4);
+
+    KeywordCheck check;
+    mgr->PlanKeywordCheck(handles, 4, false, check);
+
+    if (mgr->HasKeywords(form->refID, check))
     {
         *result = 1;
-        return true;
     }
 
     return true;
 }
 
-bool Cmd_HasAllKeywords_Execute(COMMAND_ARGS)
+bool Cmd_HasAllKeywordsH_Execute(COMMAND_ARGS)
 {
     *result = 0;
 
     TESForm* form = nullptr;
-    char keyword1[512] = "";
-    char keyword2[512] = "";
-    char keyword3[512] = "";
-    char keyword4[512] = "";
+    UInt32 handles[4] = { 0 };
 
-    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &keyword1, &keyword2, &keyword3, &keyword4))
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &handles[0], &handles[1], &handles[2], &handles[3]))
     {
         return true;
     }
@@ -619,38 +1839,31 @@ bool Cmd_HasAllKeywords_Execute(COMMAND_ARGS)
 
     KeywordManager* mgr = KeywordManager::GetSingleton();
 
-    if (keyword1[0] && !mgr->HasKeyword(form->refID, keyword1))
-    {
-        return true;
-    }
-    if (keyword2[0] && !mgr->HasKeyword(form->refID, keyword2))
-    {
-        return true;
-    }
-    if (keyword3[0] && !mgr->HasKeyword(form->refID, keyword3))
+    // A handle that names no keyword cannot be on this form
+    if (ResolveScriptHandles(mgr, handles, 4) > 0)
     {
         return true;
     }
-    if (keyword4[0] && !mgr->HasKeyword(form->refID, keyword4))
+
+    KeywordCheck check;
+    mgr->PlanKeywordCheck(handles, 4, true, check);
+
+    if (mgr->HasKeywords(form->refID, check))
     {
-        return true;
+        *result = 1;
     }
 
-    *result = 1;
     return true;
 }
 
-bool Cmd_HasAllKeywordsRef_Execute(COMMAND_ARGS)
+bool Cmd_HasAllKeywordsHRef_Execute(COMMAND_ARGS)
 {
     *result = 0;
 
     TESObjectREFR* form = nullptr;
-    char keyword1[512] = "";
-    char keyword2[512] = "";
-    char keyword3[512] = "";
-    char keyword4[512] = "";
+    UInt32 handles[4] = { 0 };
 
-    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &keyword1, &keyword2, &keyword3, &keyword4))
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, &handles[0], &handles[1], &handles[2], &handles[3]))
     {
         return true;
     }
@@ -662,94 +1875,97 @@ bool Cmd_HasAllKeywordsRef_Execute(COMMAND_ARGS)
 
     KeywordManager* mgr = KeywordManager::GetSingleton();
 
-    if (keyword1[0] && !mgr->HasKeyword(form->refID, keyword1))
-    {
-        return true;
-    }
-    if (keyword2[0] && !mgr->HasKeyword(form->refID, keyword2))
-    {
-        return true;
-    }
-    if (keyword3[0] && !mgr->HasKeyword(form->refID, keyword3))
+    // A handle that names no keyword cannot be on this form
+    if (ResolveScriptHandles(mgr, handles, 4) > 0)
     {
         return true;
     }
-    if (keyword4[0] && !mgr->HasKeyword(form->refID, keyword4))
+
+    KeywordCheck check;
+    mgr->PlanKeywordCheck(handles, 4, true, check);
+
+    if (mgr->HasKeywords(form->refID, check))
     {
-        return true;
+        *result = 1;
     }
 
-    *result = 1;
     return true;
 }
 
-bool Cmd_PrintKeywords_Execute(COMMAND_ARGS)
+// GetFormsWithKeywords "Weapon & Silver & !Unique"
+// Returns an array of every loaded form matching the expression.
+bool Cmd_GetFormsWithKeywords_Execute(COMMAND_ARGS)
 {
     *result = 0;
+    char expression[512] = { 0 };
 
-    TESForm* form = nullptr;
-
-    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form))
-    {
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, expression))
         return true;
-    }
 
-    if (!form)
-    {
+    if (!g_arrayInterface)
         return true;
-    }
 
-    auto keywords = KeywordManager::GetSingleton()->GetKeywords(form->refID);
-
-    Console_Print("Keywords for form %08X:", form->refID);
-    if (keywords.empty())
+    std::vector<UInt32> formIDs;
+    if (const KeywordExpr* expr = KeywordExprCache::Get(expression))
     {
-        Console_Print("  (none)");
+        KeywordManager::GetSingleton()->FindForms(*expr, formIDs);
     }
-    else
+
+    std::vector<OBSEArrayVarInterface::Element> elements;
+    elements.reserve(formIDs.size());
+    for (UInt32 formID : formIDs)
     {
-        for (const auto& keyword : keywords)
+        if (TESForm* form = LookupFormByID(formID))
         {
-            Console_Print("  %s", keyword.c_str());
+            elements.emplace_back(form);
         }
     }
 
-    *result = keywords.size();
+    OBSEArrayVarInterface::Array* arr = g_arrayInterface->CreateArray(
+        elements.data(), elements.size(), scriptObj);
+    g_arrayInterface->AssignCommandResult(arr, result);
     return true;
 }
 
-bool Cmd_PrintKeywordsRef_Execute(COMMAND_ARGS)
+// ===== Keyword expressions =====
+
+// HasKeywordExpr form "Weapon & (Blade | Axe) & !Broken"
+// Returns 1 if the form matches the expression, 0 if not or if it does not parse.
+bool Cmd_HasKeywordExpr_Execute(COMMAND_ARGS)
 {
     *result = 0;
+    TESForm* form = nullptr;
+    char expression[512] = { 0 };
+
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, expression))
+        return true;
+
+    if (!form)
+        return true;
+
+    const KeywordExpr* expr = KeywordExprCache::Get(expression);
+    if (expr && KeywordManager::GetSingleton()->HasKeywordExpr(form->refID, *expr))
+        *result = 1;
 
+    return true;
+}
+
+bool Cmd_HasKeywordExprRef_Execute(COMMAND_ARGS)
+{
+    *result = 0;
     TESObjectREFR* form = nullptr;
+    char expression[512] = { 0 };
 
-    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form))
-    {
+    if (!ExtractArgs(PASS_EXTRACT_ARGS, &form, expression))
         return true;
-    }
 
     if (!form)
-    {
         return true;
-    }
-
-    auto keywords = KeywordManager::GetSingleton()->GetKeywords(form->refID);
 
-    Console_Print("Keywords for form %08X:", form->refID);
-    if (keywords.empty())
-    {
-        Console_Print("  (none)");
-    }
-    else
-    {
-        for (const auto& keyword : keywords)
-        {
-            Console_Print("  %s", keyword.c_str());
-        }
-    }
+    const KeywordExpr* expr = KeywordExprCache::Get(expression);
+    if (expr && KeywordManager::GetSingleton()->HasKeywordExpr(form->refID, *expr))
+        *result = 1;
 
-    *result = keywords.size();
     return true;
 }
 
@@ -797,6 +2013,50 @@ static ParamInfo kParams_RefAndFourKeywords[] = {
     { "keyword4", kParamType_String,  1 },
 };
 
+static ParamInfo kParams_OneString[] = {
+    { "keyword", kParamType_String, 0 },
+};
+
+static ParamInfo kParams_FormAndHandle[] = {
+    { "form",   kParamType_TESObject, 0 },
+    { "handle", kParamType_Integer,  0 },
+};
+
+static ParamInfo kParams_RefAndHandle[] = {
+    { "form",   kParamType_ObjectRef, 0 },
+    { "handle", kParamType_Integer,  0 },
+};
+
+static ParamInfo kParams_FormAndFourHandles[] = {
+    { "form",    kParamType_TESObject, 0 },
+    { "handle1", kParamType_Integer,  0 },
+    { "handle2", kParamType_Integer,  1 },
+    { "handle3", kParamType_Integer,  1 },
+    { "handle4", kParamType_Integer,  1 },
+};
+
+static ParamInfo kParams_RefAndFourHandles[] = {
+    { "form",    kParamType_ObjectRef, 0 },
+    { "handle1", kParamType_Integer,  0 },
+    { "handle2", kParamType_Integer,  1 },
+    { "handle3", kParamType_Integer,  1 },
+    { "handle4", kParamType_Integer,  1 },
+};
+
+static ParamInfo kParams_FormAndExpression[] = {
+    { "form",       kParamType_TESObject, 0 },
+    { "expression", kParamType_String,  0 },
+};
+
+static ParamInfo kParams_RefAndExpression[] = {
+    { "form",       kParamType_ObjectRef, 0 },
+    { "expression", kParamType_String,  0 },
+};
+
+static ParamInfo kParams_OneExpression[] = {
+    { "expression", kParamType_String, 0 },
+};
+
 // ===== Command Info Definitions =====
 
 DEFINE_COMMAND_PLUGIN(AddKeyword, "Adds a keyword to a form", 0, 2, kParams_OneForm_OneString);
@@ -816,4 +2076,15 @@ DEFINE_COMMAND_PLUGIN(HasAnyKeywordRef, "Returns 1 if ref has any of up to 4 key
 DEFINE_COMMAND_PLUGIN(HasAllKeywords, "Returns 1 if form has all of up to 4 keywords", 0, 5, kParams_FormAndFourKeywords);
 DEFINE_COMMAND_PLUGIN(HasAllKeywordsRef, "Returns 1 if ref has all of up to 4 keywords", 0, 5, kParams_RefAndFourKeywords);
 DEFINE_COMMAND_PLUGIN(PrintKeywords, "Prints all keywords for a form to the console", 0, 1, kParams_OneForm);
-DEFINE_COMMAND_PLUGIN(PrintKeywordsRef, "Prints all keywords for a ref to the console", 0, 1, kParams_OneRef);
\ No newline at end of file
+DEFINE_COMMAND_PLUGIN(PrintKeywordsRef, "Prints all keywords for a ref to the console", 0, 1, kParams_OneRef);
+DEFINE_COMMAND_PLUGIN(PrintKeywordStats, "Prints keyword table sizes and memory use to the console", 0, 0, nullptr);
+DEFINE_COMMAND_PLUGIN(GetKeywordHandle, "Returns an integer handle for a keyword, for use with the *H commands", 0, 1, kParams_OneString);
+DEFINE_COMMAND_PLUGIN(HasKeywordH, "Returns 1 if a form has the keyword with the given handle", 0, 2, kParams_FormAndHandle);
+DEFINE_COMMAND_PLUGIN(HasKeywordHRef, "Returns 1 if a ref has the keyword with the given handle", 0, 2, kParams_RefAndHandle);
+DEFINE_COMMAND_PLUGIN(HasAnyKeywordH, "Returns 1 if form has any of up to 4 keyword handles", 0, 5, kParams_FormAndFourHandles);
+DEFINE_COMMAND_PLUGIN(HasAnyKeywordHRef, "Returns 1 if ref has any of up to 4 keyword handles", 0, 5, kParams_RefAndFourHandles);
+DEFINE_COMMAND_PLUGIN(HasAllKeywordsH, "Returns 1 if form has all of up to 4 keyword handles", 0, 5, kParams_FormAndFourHandles);
+DEFINE_COMMAND_PLUGIN(HasAllKeywordsHRef, "Returns 1 if ref has all of up to 4 keyword handles", 0, 5, kParams_RefAndFourHandles);
+DEFINE_COMMAND_PLUGIN(HasKeywordExpr, "Returns 1 if a form matches a keyword expression such as \"A & (B | C) & !D\"", 0, 2, kParams_FormAndExpression);
+DEFINE_COMMAND_PLUGIN(HasKeywordExprRef, "Returns 1 if a ref matches a keyword expression such as \"A & (B | C) & !D\"", 0, 2, kParams_RefAndExpression);
+DEFINE_COMMAND_PLUGIN(GetFormsWithKeywords, "Returns an array of all forms matching a keyword expression", 0, 1, kParams_OneExpression);
\ No newline at end of file
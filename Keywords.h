@@ -5,46 +5,275 @@
 #include "obse/GameAPI.h"
 #include "obse/GameForms.h"
 #include "obse/ParamInfos.h"
+#include "FormMap.h"
+#include "FrozenIndex.h"
+#include "KeywordSet.h"
+#include "KeywordExpr.h"
+#include "PostingList.h"
 #include <string>
-#include <map>
-#include <set>
+#include <string_view>
+#include <deque>
+#include <functional>
+#include <unordered_map>
 #include <vector>
 
 // Plugin version
 #define PLUGIN_VERSION 1
 
+// Keyword ID reserved for "no such keyword"
+static const UInt32 kInvalidKeywordID = 0;
+
+// Stands in for the keyword ID of a script handle that two keywords share
+static const UInt32 kAmbiguousScriptHandle = 0xFFFFFFFF;
+
+// ASCII case folding, matching ::tolower in the "C" locale
+inline char FoldKeywordChar(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// Case-insensitive hash and equality so keyword lookups can run directly
+// on the caller's string without building a lowercase copy first
+struct KeywordHash
+{
+    size_t operator()(std::string_view keyword) const
+    {
+        // FNV-1a over the case-folded bytes
+        UInt32 hash = 0x811c9dc5;
+        for (char c : keyword)
+        {
+            hash ^= static_cast<UInt8>(FoldKeywordChar(c));
+            hash *= 0x01000193;
+        }
+        return hash;
+    }
+};
+
+struct KeywordEqual
+{
+    bool operator()(std::string_view a, std::string_view b) const
+    {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (FoldKeywordChar(a[i]) != FoldKeywordChar(b[i])) return false;
+        }
+        return true;
+    }
+};
+
+// Where a keyword assignment comes from.  INI keywords form a layer built
+// once per session (and rebuilt only by ReloadKeywordINIs); only runtime
+// changes go into the save.
+enum KeywordSource
+{
+    kSource_Runtime,    // script commands, other plugins, saves
+    kSource_INI,        // Data/OBSE/Plugins/OBSEKeywords/*.ini
+};
+
+// Memory accounting for the keyword tables
+struct KeywordMemoryStats
+{
+    UInt32 numForms = 0;        // forms with at least one keyword
+    UInt32 numFrozenForms = 0;  // forms read from the frozen INI index
+    UInt32 numInlineForms = 0;  // runtime forms whose keywords fit inside their table slot
+    UInt32 numTags = 0;         // total (form, keyword) assignments
+    UInt32 numKeywords = 0;     // interned keyword strings
+    UInt32 frozenBytes = 0;     // frozen INI index
+    UInt32 formTableBytes = 0;  // FormMap slot array of the runtime layer
+    UInt32 spilledBytes = 0;    // heap storage of runtime forms that did not fit inline
+    UInt32 numRuntimeForms = 0; // forms edited at runtime (saved in the co-save)
+};
+
+// Set KEYWORDS_PLANNER_STATS=1 to measure how many keyword checks the
+// query planner saves.  Debug builds only: measuring re-runs every
+// reordered check in its written order, which costs more than the planner
+// saves.
+#ifndef KEYWORDS_PLANNER_STATS
+#define KEYWORDS_PLANNER_STATS 0
+#endif
+
+// An any-of / all-of check, with its keywords ordered by the query planner
+struct KeywordCheck
+{
+    static const UInt32 kMaxKeywords = 4;
+
+    UInt32 keywordIDs[kMaxKeywords];    // planned order
+    UInt32 writtenIDs[kMaxKeywords];    // caller's order, for the stats
+    UInt32 count = 0;
+    bool   matchAll = false;
+    bool   reordered = false;
+};
+
+struct KeywordPlannerStats
+{
+    UInt64 checks = 0;              // any-of / all-of checks run
+    UInt64 reorderedChecks = 0;     // checks whose planned order differed
+    UInt64 comparisons = 0;         // keyword lookups made in planned order
+    UInt64 writtenComparisons = 0;  // lookups the written order would have made
+};
+
 // Keyword system class
 class KeywordManager
 {
 private:
-    // Map of form ID -> set of keyword strings
-    std::map<UInt32, std::set<std::string>> formKeywords;
+    // Interned lowercase keyword strings, indexed by keyword ID.
+    // A deque keeps the strings at stable addresses as the table grows.
+    std::deque<std::string> keywordNames;
+
+    // Map of keyword -> keyword ID. Keys view into keywordNames and are
+    // hashed and compared case-insensitively.
+    std::unordered_map<std::string_view, UInt32, KeywordHash, KeywordEqual> keywordIDs;
+
+    // Map of script handle -> keyword ID, kAmbiguousScriptHandle when the
+    // names of two or more keywords give the same handle
+    FormMap<UInt32> scriptHandles;
+
+    // Keywords are kept in two layers.  The INI layer is built once per
+    // session by BuildBaseline and is not touched by loading a save.  The
+    // runtime layer holds the full keyword set of every form edited since
+    // (by scripts, plugins or a loaded save) and hides that form's INI
+    // entry; an empty set hides it entirely.
+
+    // INI layer, frozen into a compact read-only index (both directions)
+    // once the INI files are loaded.  iniStaging collects it meanwhile,
+    // and iniStagingPairs what arrives already sorted.
+    FrozenKeywordIndex baseKeywords;
+    FormMap<KeywordSet> iniStaging;
+    std::vector<UInt64> iniStagingPairs;
 
-    // Map of keyword -> set of form IDs (reverse index for fast lookup)
-    std::map<std::string, std::set<UInt32>> keywordForms;
+    // Runtime layer: form ID -> keyword IDs, and keyword ID -> sorted form
+    // IDs.  shadowedForms lists, per keyword, the forms whose INI entry the
+    // runtime layer hides.  The forms that have a keyword are its INI list
+    // - shadowedForms + runtimeForms.
+    FormMap<KeywordSet> runtimeKeywords;
+    std::vector<PostingList> runtimeForms;
+    std::vector<PostingList> shadowedForms;
+
+    KeywordPlannerStats plannerStats;
 
     static KeywordManager* instance;
 
-    KeywordManager() {}
+    KeywordManager();
+
+    // Calls func with formID's keywords: a KeywordSet from the runtime layer
+    // or a KeywordSpan from the INI layer (empty if the form has none)
+    template <class Func>
+    auto VisitKeywords(UInt32 formID, Func&& func) const
+    {
+        if (const KeywordSet* keywords = runtimeKeywords.Find(formID))
+        {
+            return func(*keywords);
+        }
+        return func(baseKeywords.Find(formID));
+    }
+
+    KeywordSet& EditKeywords(UInt32 formID);
+    void DropRuntimeEdit(UInt32 formID);
+    UInt32 CountKeywordForms(UInt32 keywordID) const;
+    void CollectKeywordForms(UInt32 keywordID, std::vector<UInt32>& outFormIDs);
+    std::vector<UInt32> GetTaggedForms() const;
+    void LoadPackedRecord(OBSESerializationInterface* intfc, UInt32 version, UInt32 length,
+        std::vector<UInt8>& buffer, std::vector<UInt32>& formKeywordIDs);
 
 public:
     static KeywordManager* GetSingleton();
 
+    // Keyword interning. IDs are dense, never reused, and stay valid for the
+    // whole session (clearing keywords does not clear the intern table).
+    UInt32 InternKeyword(std::string_view keyword);
+    UInt32 FindKeywordID(std::string_view keyword) const;
+    const char* GetKeywordName(UInt32 keywordID) const;
+    UInt32 GetNumKeywordIDs() const { return keywordNames.size(); }
+
+    // Script handles, as returned by GetKeywordHandle.  Scripts keep them in
+    // quest variables, so unlike keyword IDs they must mean the same keyword
+    // in every session: a handle is a hash of the keyword's name, kept below
+    // 2^31 to fit a long variable.  A handle shared by two keywords' names
+    // resolves to neither, and GetScriptHandle returns 0 for both.
+    static UInt32 ScriptHandleOf(std::string_view keyword);
+    UInt32 GetScriptHandle(UInt32 keywordID) const;
+    UInt32 ResolveScriptHandle(UInt32 handle) const;
+
     // Core keyword functions
-    bool AddKeyword(UInt32 formID, const std::string& keyword);
-    bool RemoveKeyword(UInt32 formID, const std::string& keyword);
-    bool HasKeyword(UInt32 formID, const std::string& keyword);
+    bool AddKeyword(UInt32 formID, std::string_view keyword, KeywordSource source = kSource_Runtime);
+    bool AddKeywordID(UInt32 formID, UInt32 keywordID, KeywordSource source = kSource_Runtime);
+
+    // Adds several keywords to one form.  Skips invalid IDs; keywordIDs is
+    // sorted and deduplicated in place.
+    void AddKeywordIDs(UInt32 formID, UInt32* keywordIDs, UInt32 count);
+    bool RemoveKeyword(UInt32 formID, std::string_view keyword);
+    void RemoveKeywordID(UInt32 formID, UInt32 keywordID);
+    bool HasKeyword(UInt32 formID, std::string_view keyword);
+    bool HasKeywordID(UInt32 formID, UInt32 keywordID);
+
+    // Multi-keyword queries.  BuildKeywordMask reads keywords until count or
+    // the first null entry, skips empty strings, and returns how many of the
+    // keywords were never interned (and so cannot be on any form).
+    UInt32 BuildKeywordMask(const char* const* keywords, UInt32 count, KeywordMask& outMask) const;
+    UInt32 BuildKeywordMask(const UInt32* keywordIDs, UInt32 count, KeywordMask& outMask) const;
+    bool HasAnyKeyword(UInt32 formID, const KeywordMask& mask);
+    bool HasAllKeywords(UInt32 formID, const KeywordMask& mask);
+    bool HasKeywordExpr(UInt32 formID, const KeywordExpr& expr);
+
+    // Writes 1 or 0 to outResults[i] for whether formID has keywordIDs[i],
+    // finding the form's keywords once for the whole list
+    void HasKeywordIDs(UInt32 formID, const UInt32* keywordIDs, UInt32 count, UInt8* outResults);
+
+    // Query planner.  Orders up to KeywordCheck::kMaxKeywords keyword IDs
+    // for a short-circuiting check using each keyword's form count: rarest
+    // first for all-of (most likely to fail early), most common first for
+    // any-of (most likely to succeed early).  Like BuildKeywordMask, it skips
+    // kInvalidKeywordID entries and returns how many IDs were out of range.
+    UInt32 FindKeywordIDs(const char* const* keywords, UInt32 count, UInt32* outIDs) const;
+    UInt32 PlanKeywordCheck(const UInt32* keywordIDs, UInt32 count, bool matchAll, KeywordCheck& outCheck) const;
+    bool HasKeywords(UInt32 formID, const KeywordCheck& check);
+    const KeywordPlannerStats& GetPlannerStats() const { return plannerStats; }
 
     // Query functions
     std::vector<std::string> GetKeywords(UInt32 formID);
-    std::vector<UInt32> GetFormsWithKeyword(const std::string& keyword);
+
+    // Writes up to capacity of formID's keyword IDs, in ascending order,
+    // and returns how many the form has
+    UInt32 GetKeywordIDs(UInt32 formID, UInt32* outIDs, UInt32 capacity);
+
+    // As GetKeywordIDs, but writes pointers to the interned keyword names.
+    // The intern table is never cleared, so the pointers stay valid for the
+    // session; nothing is copied.
+    UInt32 GetKeywordNames(UInt32 formID, const char** outNames, UInt32 capacity);
+
+    // Name of formID's index-th keyword (same order), or "" if out of range
+    const char* GetNthKeyword(UInt32 formID, UInt32 index);
+    std::vector<UInt32> GetFormsWithKeyword(std::string_view keyword);
+    bool FindForms(const KeywordExpr& expr, std::vector<UInt32>& outFormIDs);
     int GetKeywordCount(UInt32 formID);
 
+    // Rebuilds the INI layer by running loadINIs, which should add keywords
+    // with kSource_INI.  Runtime changes are kept on top of the new layer.
+    void BuildBaseline(const std::function<void()>& loadINIs);
+
+    // For loadINIs: adds sorted, unique (formID << 32 | keywordID) pairs to
+    // the INI layer as AddKeywordID with kSource_INI would, but they go
+    // into the frozen index in one merge pass, without a set per form
+    void AddBaselinePairs(std::vector<UInt64>&& pairs);
+
+    // Changes the INI layer in place: adds and removes the given sorted
+    // (formID << 32 | keywordID) pairs.  Runtime changes to the affected
+    // forms are kept on top, as with BuildBaseline.
+    void PatchBaseline(const std::vector<UInt64>& added, const std::vector<UInt64>& removed);
+
     // Utility
     void ClearFormKeywords(UInt32 formID);
+    void ClearRuntimeKeywords();
     void ClearAllKeywords();
 
-    // Serialization
+    // Diagnostics
+    KeywordMemoryStats GetMemoryStats() const;
+    void LogMemoryStats() const;
+
+    // Serialization.  Save writes only the runtime layer, as changes against
+    // the INI layer; Load applies a save on top of the current keywords, so
+    // clear the runtime layer first.
     void Save(OBSESerializationInterface* intfc);
     void Load(OBSESerializationInterface* intfc);
     void NewGame();
@@ -60,6 +289,13 @@ bool Cmd_GetNthKeyword_Execute(COMMAND_ARGS);
 bool Cmd_HasAnyKeyword_Execute(COMMAND_ARGS);
 bool Cmd_HasAllKeywords_Execute(COMMAND_ARGS);
 bool Cmd_PrintKeywords_Execute(COMMAND_ARGS);
+bool Cmd_PrintKeywordStats_Execute(COMMAND_ARGS);
+bool Cmd_GetKeywordHandle_Execute(COMMAND_ARGS);
+bool Cmd_HasKeywordH_Execute(COMMAND_ARGS);
+bool Cmd_HasAnyKeywordH_Execute(COMMAND_ARGS);
+bool Cmd_HasAllKeywordsH_Execute(COMMAND_ARGS);
+bool Cmd_HasKeywordExpr_Execute(COMMAND_ARGS);
+bool Cmd_GetFormsWithKeywords_Execute(COMMAND_ARGS);
 
 // Command info structures
 extern CommandInfo kCommandInfo_AddKeyword;
@@ -80,7 +316,19 @@ extern CommandInfo kCommandInfo_HasAllKeywords;
 extern CommandInfo kCommandInfo_HasAllKeywordsRef;
 extern CommandInfo kCommandInfo_PrintKeywords;
 extern CommandInfo kCommandInfo_PrintKeywordsRef;
+extern CommandInfo kCommandInfo_PrintKeywordStats;
+extern CommandInfo kCommandInfo_GetKeywordHandle;
+extern CommandInfo kCommandInfo_HasKeywordH;
+extern CommandInfo kCommandInfo_HasKeywordHRef;
+extern CommandInfo kCommandInfo_HasAnyKeywordH;
+extern CommandInfo kCommandInfo_HasAnyKeywordHRef;
+extern CommandInfo kCommandInfo_HasAllKeywordsH;
+extern CommandInfo kCommandInfo_HasAllKeywordsHRef;
+extern CommandInfo kCommandInfo_HasKeywordExpr;
+extern CommandInfo kCommandInfo_HasKeywordExprRef;
+extern CommandInfo kCommandInfo_GetFormsWithKeywords;
 
 extern OBSEScriptInterface* g_scriptInterface;
+extern OBSEArrayVarInterface* g_arrayInterface;
 #define ExtractArgsEx(...) g_scriptInterface->ExtractArgsEx(__VA_ARGS__)
 #define ExtractFormatStringArgs(...) g_scriptInterface->ExtractFormatStringArgs(__VA_ARGS__)
\ No newline at end of file
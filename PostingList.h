@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+// ============================================================
+//  Posting lists
+//
+//  The keyword -> forms reverse index keeps, for each keyword,
+//  a sorted array of form IDs (a "posting list" in search
+//  engine terms).  Sorted arrays make multi-keyword queries
+//  cheap: intersections gallop through the larger list with
+//  exponential search, so intersecting a 20-form list with a
+//  20 000-form list costs ~20 * log(1000) steps rather than
+//  20 000.
+//
+//  Appends in ascending form ID order (the common case while
+//  loading) keep the list sorted for free.  Out-of-order
+//  appends just mark it unsorted; it is sorted once on the
+//  next read.
+// ============================================================
+
+class PostingList
+{
+public:
+    PostingList() : sorted(true) {}
+
+    // formID must not already be in the list
+    void Add(UInt32 formID)
+    {
+        if (sorted && !ids.empty() && formID < ids.back())
+        {
+            sorted = false;
+        }
+        ids.push_back(formID);
+    }
+
+    void Remove(UInt32 formID)
+    {
+        Normalize();
+        auto it = std::lower_bound(ids.begin(), ids.end(), formID);
+        if (it != ids.end() && *it == formID)
+        {
+            ids.erase(it);
+        }
+    }
+
+    void Clear()
+    {
+        ids.clear();
+        sorted = true;
+    }
+
+    // Sorted view of the list
+    const std::vector<UInt32>& Get()
+    {
+        Normalize();
+        return ids;
+    }
+
+    UInt32 Size() const { return ids.size(); }
+
+private:
+    void Normalize()
+    {
+        if (!sorted)
+        {
+            std::sort(ids.begin(), ids.end());
+            sorted = true;
+        }
+    }
+
+    std::vector<UInt32> ids;
+    bool                sorted;
+};
+
+namespace PostingOps
+{
+    // First index in [first, size) whose value is >= target, found by
+    // doubling the step from first and then binary searching the last gap
+    inline UInt32 Gallop(const UInt32* data, UInt32 size, UInt32 first, UInt32 target)
+    {
+        UInt32 step = 1;
+        UInt32 hi = first;
+        while (hi < size && data[hi] < target)
+        {
+            first = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        return std::lower_bound(data + first, data + std::min(hi, size), target) - data;
+    }
+
+    // result = result AND other.  result should be the smaller list.
+    inline void IntersectInto(std::vector<UInt32>& result, const UInt32* other, UInt32 otherSize)
+    {
+        UInt32 out = 0;
+        UInt32 pos = 0;
+        for (UInt32 formID : result)
+        {
+            pos = Gallop(other, otherSize, pos, formID);
+            if (pos == otherSize) break;
+            if (other[pos] == formID)
+            {
+                result[out++] = formID;
+            }
+        }
+        result.resize(out);
+    }
+
+    // result = result AND NOT other
+    inline void SubtractInto(std::vector<UInt32>& result, const UInt32* other, UInt32 otherSize)
+    {
+        UInt32 out = 0;
+        UInt32 pos = 0;
+        for (UInt32 formID : result)
+        {
+            pos = Gallop(other, otherSize, pos, formID);
+            if (pos == otherSize || other[pos] != formID)
+            {
+                result[out++] = formID;
+            }
+        }
+        result.resize(out);
+    }
+
+    // result = result OR other
+    inline void UnionInto(std::vector<UInt32>& result, const UInt32* other, UInt32 otherSize)
+    {
+        std::vector<UInt32> merged;
+        merged.reserve(result.size() + otherSize);
+        std::set_union(result.begin(), result.end(), other, other + otherSize, std::back_inserter(merged));
+        result.swap(merged);
+    }
+}
@@ -1,15 +1,256 @@
 #include "Keywords.h"
 #include "INIParser.h"
+#include "KeywordChanges.h"
 #include "EditorIDMapper/EditorIDMapperAPI.h"
 #include "obse/PluginAPI.h"
 #include "obse_common/SafeWrite.h"
 #include <KeywordAPI.h>
+#include <chrono>
 
 IDebugLog gLog("OBSEKeywords.log");
 PluginHandle g_pluginHandle = kPluginHandle_Invalid;
 
 OBSESerializationInterface* g_serialization = nullptr;
 OBSEMessagingInterface* g_messaging = nullptr;
+OBSEArrayVarInterface* g_arrayInterface = nullptr;
+
+// ===== Direct interface =====
+//
+// Function table handed to other plugins with the ready signal and on
+// kMessage_GetInterface.  Calls through it skip the messaging round trip
+// (a Dispatch, every listener's handler and the switch below), which is
+// most of the cost of a single keyword check.
+
+namespace
+{
+    bool Intfc_AddKeyword(UInt32 formID, const char* keyword)
+    {
+        return keyword && KeywordManager::GetSingleton()->AddKeyword(formID, keyword);
+    }
+
+    bool Intfc_RemoveKeyword(UInt32 formID, const char* keyword)
+    {
+        return keyword && KeywordManager::GetSingleton()->RemoveKeyword(formID, keyword);
+    }
+
+    bool Intfc_HasKeyword(UInt32 formID, const char* keyword)
+    {
+        return keyword && KeywordManager::GetSingleton()->HasKeyword(formID, keyword);
+    }
+
+    UInt32 Intfc_GetKeywordCount(UInt32 formID)
+    {
+        return KeywordManager::GetSingleton()->GetKeywordCount(formID);
+    }
+
+    void Intfc_ClearKeywords(UInt32 formID)
+    {
+        KeywordManager::GetSingleton()->ClearFormKeywords(formID);
+    }
+
+    bool Intfc_HasKeywordExpr(UInt32 formID, const char* expression)
+    {
+        const KeywordExpr* expr = expression ? KeywordExprCache::Get(expression) : nullptr;
+        return expr && KeywordManager::GetSingleton()->HasKeywordExpr(formID, *expr);
+    }
+
+    UInt32 Intfc_GetKeywordHandle(const char* keyword)
+    {
+        return keyword ? KeywordManager::GetSingleton()->InternKeyword(keyword) : kInvalidKeywordID;
+    }
+
+    const char* Intfc_GetKeywordName(UInt32 handle)
+    {
+        return KeywordManager::GetSingleton()->GetKeywordName(handle);
+    }
+
+    bool Intfc_AddKeywordH(UInt32 formID, UInt32 handle)
+    {
+        return KeywordManager::GetSingleton()->AddKeywordID(formID, handle);
+    }
+
+    bool Intfc_RemoveKeywordH(UInt32 formID, UInt32 handle)
+    {
+        KeywordManager* mgr = KeywordManager::GetSingleton();
+        if (handle == kInvalidKeywordID || handle >= mgr->GetNumKeywordIDs()) return false;
+
+        mgr->RemoveKeywordID(formID, handle);
+        return true;
+    }
+
+    bool Intfc_HasKeywordH(UInt32 formID, UInt32 handle)
+    {
+        return KeywordManager::GetSingleton()->HasKeywordID(formID, handle);
+    }
+
+    // Up to four handles go through the query planner like the script
+    // commands; longer lists are tested against a mask in one pass
+    bool HasKeywordsH(UInt32 formID, const UInt32* handles, UInt32 count, bool matchAll)
+    {
+        KeywordManager* mgr = KeywordManager::GetSingleton();
+        if (!handles) count = 0;
+
+        // A handle that was never issued cannot be on the form
+        if (count <= KeywordCheck::kMaxKeywords)
+        {
+            KeywordCheck check;
+            UInt32 numUnknown = mgr->PlanKeywordCheck(handles, count, matchAll, check);
+            return !(matchAll && numUnknown) && mgr->HasKeywords(formID, check);
+        }
+
+        KeywordMask mask;
+        UInt32 numUnknown = mgr->BuildKeywordMask(handles, count, mask);
+        return matchAll
+            ? !numUnknown && mgr->HasAllKeywords(formID, mask)
+            : mgr->HasAnyKeyword(formID, mask);
+    }
+
+    bool Intfc_HasAnyKeywordH(UInt32 formID, const UInt32* handles, UInt32 count)
+    {
+        return HasKeywordsH(formID, handles, count, false);
+    }
+
+    bool Intfc_HasAllKeywordsH(UInt32 formID, const UInt32* handles, UInt32 count)
+    {
+        return HasKeywordsH(formID, handles, count, true);
+    }
+
+    // Keyword list queries (MultiKeywordDataV2).  Strings are resolved
+    // once, then HasKeywordsH reads the form's keywords in one pass.
+    bool Intfc_HasKeywordList(KeywordAPI::MultiKeywordDataV2* data)
+    {
+        // A string that was never interned cannot be on the form, so it is
+        // passed on as a handle that was never issued: all-of fails on it
+        // and any-of skips it
+        static const UInt32 kUnknownKeywordID = 0xFFFFFFFF;
+
+        KeywordManager* mgr = KeywordManager::GetSingleton();
+        data->serverVersion = KeywordAPI::kMultiKeywordDataVersion;
+        if (data->mode > KeywordAPI::kMatch_None) return data->result = false;
+
+        UInt32 count = data->count;
+        const UInt32* keywordIDs = data->handles;
+        UInt32 stackIDs[16];
+        std::vector<UInt32> heapIDs;
+        if (data->keywords)
+        {
+            UInt32* resolved = stackIDs;
+            if (count > std::size(stackIDs))
+            {
+                heapIDs.resize(count);
+                resolved = heapIDs.data();
+            }
+            for (UInt32 i = 0; i < count; ++i)
+            {
+                const char* keyword = data->keywords[i];
+                resolved[i] = kInvalidKeywordID;
+                if (!keyword || !keyword[0]) continue;
+
+                resolved[i] = mgr->FindKeywordID(keyword);
+                if (resolved[i] == kInvalidKeywordID) resolved[i] = kUnknownKeywordID;
+            }
+            keywordIDs = resolved;
+        }
+
+        bool matchAll = data->mode == KeywordAPI::kMatch_All;
+        bool found = HasKeywordsH(data->formID, keywordIDs, count, matchAll);
+        return data->result = data->mode == KeywordAPI::kMatch_None ? !found : found;
+    }
+
+    UInt32 Intfc_GetKeywordHandles(UInt32 formID, UInt32* outHandles, UInt32 capacity)
+    {
+        return KeywordManager::GetSingleton()->GetKeywordIDs(formID, outHandles, outHandles ? capacity : 0);
+    }
+
+    UInt32 Intfc_GetKeywordNames(UInt32 formID, const char** outKeywords, UInt32 capacity)
+    {
+        return KeywordManager::GetSingleton()->GetKeywordNames(formID, outKeywords, outKeywords ? capacity : 0);
+    }
+
+    UInt32 Intfc_Subscribe(KeywordAPI::SubscribeData* data)
+    {
+        return data->subscriptionID = KeywordChangeLog::Subscribe(*data);
+    }
+
+    bool Intfc_Unsubscribe(UInt32 subscriptionID)
+    {
+        return KeywordChangeLog::Unsubscribe(subscriptionID);
+    }
+
+    void Intfc_FlushChanges()
+    {
+        KeywordChangeLog::Flush();
+    }
+
+    void Intfc_HasKeywordsBatch(KeywordAPI::BatchData* batch)
+    {
+        // A malformed batch is left unhandled rather than read
+        if (!batch) return;
+        if (batch->numForms && !batch->formIDs) return;
+        if (batch->numKeywords && !batch->keywords && !batch->handles) return;
+
+        KeywordManager* mgr = KeywordManager::GetSingleton();
+        batch->handled = true;
+
+        // Strings are resolved once here rather than once per form
+        UInt32 numKeywords = batch->numKeywords;
+        std::vector<UInt32> keywordIDs(numKeywords, kInvalidKeywordID);
+        for (UInt32 k = 0; k < numKeywords; ++k)
+        {
+            if (batch->keywords)
+            {
+                if (batch->keywords[k]) keywordIDs[k] = mgr->FindKeywordID(batch->keywords[k]);
+            }
+            else if (batch->handles)
+            {
+                keywordIDs[k] = batch->handles[k];
+            }
+        }
+
+        UInt32 numWords = (numKeywords + 63) / 64;
+        std::vector<UInt8> row(batch->results ? 0 : numKeywords);
+        for (UInt32 f = 0; f < batch->numForms; ++f)
+        {
+            UInt8* results = batch->results ? batch->results + f * numKeywords : row.data();
+            mgr->HasKeywordIDs(batch->formIDs[f], keywordIDs.data(), numKeywords, results);
+
+            if (batch->masks)
+            {
+                UInt64* mask = batch->masks + f * numWords;
+                std::fill(mask, mask + numWords, 0);
+                for (UInt32 k = 0; k < numKeywords; ++k)
+                {
+                    mask[k >> 6] |= static_cast<UInt64>(results[k]) << (k & 63);
+                }
+            }
+        }
+    }
+
+    KeywordAPI::KeywordInterface g_keywordInterface = {
+        KeywordAPI::kInterfaceVersion,
+        sizeof(KeywordAPI::KeywordInterface),
+        Intfc_AddKeyword,
+        Intfc_RemoveKeyword,
+        Intfc_HasKeyword,
+        Intfc_GetKeywordCount,
+        Intfc_ClearKeywords,
+        Intfc_HasKeywordExpr,
+        Intfc_GetKeywordHandle,
+        Intfc_GetKeywordName,
+        Intfc_AddKeywordH,
+        Intfc_RemoveKeywordH,
+        Intfc_HasKeywordH,
+        Intfc_HasAnyKeywordH,
+        Intfc_HasAllKeywordsH,
+        Intfc_GetKeywordHandles,
+        Intfc_HasKeywordsBatch,
+        Intfc_GetKeywordNames,
+        Intfc_Subscribe,
+        Intfc_Unsubscribe,
+        Intfc_FlushChanges,
+        Intfc_HasKeywordList,
+    };
+}
 
 void KeywordMessageHandler(OBSEMessagingInterface::Message* msg)
 {
@@ -62,44 +303,134 @@ void KeywordMessageHandler(OBSEMessagingInterface::Message* msg)
         auto* data = static_cast<KeywordAPI::GetNthData*>(msg->data);
         data->keyword[0] = '\0';  // Default to empty
 
-        auto keywords = mgr->GetKeywords(data->formID);
-        if (data->index < keywords.size())
-        {
-            strncpy_s(data->keyword, sizeof(data->keyword),
-                keywords[data->index].c_str(), _TRUNCATE);
-        }
+        strncpy_s(data->keyword, sizeof(data->keyword),
+            mgr->GetNthKeyword(data->formID, data->index), _TRUNCATE);
         break;
     }
 
     case KeywordAPI::kMessage_HasAny:
     {
         auto* data = static_cast<KeywordAPI::MultiKeywordData*>(msg->data);
-        data->result = false;
 
-        for (int i = 0; i < 4 && data->keywords[i]; ++i)
+        UInt32 keywordIDs[4];
+        mgr->FindKeywordIDs(data->keywords, 4, keywordIDs);
+
+        KeywordCheck check;
+        mgr->PlanKeywordCheck(keywordIDs, 4, false, check);
+        data->result = mgr->HasKeywords(data->formID, check);
+        break;
+    }
+
+    case KeywordAPI::kMessage_HasAll:
+    {
+        auto* data = static_cast<KeywordAPI::MultiKeywordData*>(msg->data);
+
+        // A keyword that was never interned cannot be on the form
+        UInt32 keywordIDs[4];
+        KeywordCheck check;
+        data->result = mgr->FindKeywordIDs(data->keywords, 4, keywordIDs) == 0
+            && mgr->PlanKeywordCheck(keywordIDs, 4, true, check) == 0
+            && mgr->HasKeywords(data->formID, check);
+        break;
+    }
+
+    case KeywordAPI::kMessage_HasKeywordList:
+    {
+        // Clients built against a newer header send a larger struct; only
+        // the fields this version knows are read.  Anything smaller than
+        // version 2 is left unanswered (serverVersion 0).
+        auto* data = static_cast<KeywordAPI::MultiKeywordDataV2*>(msg->data);
+        if (data && msg->dataLen >= sizeof(KeywordAPI::MultiKeywordDataV2)
+            && data->version >= 2 && data->size >= sizeof(KeywordAPI::MultiKeywordDataV2))
+        {
+            Intfc_HasKeywordList(data);
+        }
+        break;
+    }
+
+    case KeywordAPI::kMessage_HasExpr:
+    {
+        auto* data = static_cast<KeywordAPI::ExprData*>(msg->data);
+
+        const KeywordExpr* expr = data->expression ? KeywordExprCache::Get(data->expression) : nullptr;
+        data->valid = expr != nullptr;
+        data->result = expr && mgr->HasKeywordExpr(data->formID, *expr);
+        break;
+    }
+
+    case KeywordAPI::kMessage_FindForms:
+    {
+        auto* data = static_cast<KeywordAPI::FindFormsData*>(msg->data);
+        data->count = 0;
+
+        const KeywordExpr* expr = data->expression ? KeywordExprCache::Get(data->expression) : nullptr;
+        data->valid = expr != nullptr;
+        if (expr)
         {
-            if (mgr->HasKeyword(data->formID, data->keywords[i]))
+            std::vector<UInt32> formIDs;
+            mgr->FindForms(*expr, formIDs);
+
+            data->count = formIDs.size();
+            if (data->formIDs)
             {
-                data->result = true;
-                break;
+                std::copy_n(formIDs.begin(), std::min(data->count, data->capacity), data->formIDs);
             }
         }
         break;
     }
 
-    case KeywordAPI::kMessage_HasAll:
+    case KeywordAPI::kMessage_GetKeywords:
     {
-        auto* data = static_cast<KeywordAPI::MultiKeywordData*>(msg->data);
-        data->result = true;  // Assume true until proven otherwise
-
-        for (int i = 0; i < 4 && data->keywords[i]; ++i)
+        auto* data = static_cast<KeywordAPI::GetKeywordsData*>(msg->data);
+        if (data->handles)
         {
-            if (!mgr->HasKeyword(data->formID, data->keywords[i]))
+            data->count = mgr->GetKeywordIDs(data->formID, data->handles, data->capacity);
+            if (data->keywords)
             {
-                data->result = false;
-                break;
+                for (UInt32 i = 0; i < std::min(data->count, data->capacity); ++i)
+                {
+                    data->keywords[i] = mgr->GetKeywordName(data->handles[i]);
+                }
             }
         }
+        else
+        {
+            data->count = mgr->GetKeywordNames(data->formID, data->keywords,
+                data->keywords ? data->capacity : 0);
+        }
+        break;
+    }
+
+    case KeywordAPI::kMessage_HasBatch:
+    {
+        if (msg->dataLen >= sizeof(KeywordAPI::BatchData))
+        {
+            Intfc_HasKeywordsBatch(static_cast<KeywordAPI::BatchData*>(msg->data));
+        }
+        break;
+    }
+
+    case KeywordAPI::kMessage_Subscribe:
+    {
+        Intfc_Subscribe(static_cast<KeywordAPI::SubscribeData*>(msg->data));
+        break;
+    }
+
+    case KeywordAPI::kMessage_Unsubscribe:
+    {
+        auto* data = static_cast<KeywordAPI::UnsubscribeData*>(msg->data);
+        data->result = KeywordChangeLog::Unsubscribe(data->subscriptionID);
+        break;
+    }
+
+    case KeywordAPI::kMessage_FlushChanges:
+        KeywordChangeLog::Flush();
+        break;
+
+    case KeywordAPI::kMessage_GetInterface:
+    {
+        auto* data = static_cast<KeywordAPI::GetInterfaceData*>(msg->data);
+        data->intfc = &g_keywordInterface;
         break;
     }
 
@@ -108,6 +439,25 @@ void KeywordMessageHandler(OBSEMessagingInterface::Message* msg)
     }
 }
 
+// The INI layer is built at kMessage_GameInitialized.  Editor IDs that
+// missed there because EditorIDMapper was not ready yet would stay missing
+// for the session, so the layer is rebuilt on the first load or new game
+// after the mapper becomes ready.
+static void RebuildBaselineIfMapperWasNotReady()
+{
+    UInt32 misses = INILoader::GetUnreadyMisses();
+    if (!misses) return;
+
+    if (!EditorIDMapper::IsReady())
+    {
+        _WARNING("EditorIDMapper not ready  editor ID lookups will fail");
+        return;
+    }
+
+    _MESSAGE("EditorIDMapper ready, rebuilding INI keywords for %u unresolved editor ID(s)", misses);
+    KeywordManager::GetSingleton()->BuildBaseline([] { INILoader::LoadAll(); });
+}
+
 void OBSEMessageHandler(OBSEMessagingInterface::Message* msg)
 {
     if (!msg) return;
@@ -120,13 +470,21 @@ void OBSEMessageHandler(OBSEMessagingInterface::Message* msg)
         break;
     case OBSEMessagingInterface::kMessage_GameInitialized:
 
+        // The INI files are parsed once here; loading a save only replaces
+        // the runtime layer on top of them
         _MESSAGE("OBSEKeywords: loading INI files");
-        INILoader::LoadAll();
+        KeywordManager::GetSingleton()->BuildBaseline([] { INILoader::LoadAll(); });
+        KeywordManager::GetSingleton()->LogMemoryStats();
+        if (UInt32 misses = INILoader::GetUnreadyMisses())
+        {
+            _WARNING("EditorIDMapper not ready  %u editor ID(s) will be resolved on the first load", misses);
+        }
 
         _MESSAGE("OBSEKeywords: broadcasting ready signal");
 
+        // Clients take the direct interface from the signal
         g_messaging->Dispatch(g_pluginHandle, KeywordAPI::kMessage_Ready,
-            nullptr, 0, nullptr);
+            &g_keywordInterface, sizeof(g_keywordInterface), nullptr);
         break;
 
     default:
@@ -134,33 +492,38 @@ void OBSEMessageHandler(OBSEMessagingInterface::Message* msg)
     }
 }
 
-void SaveCallback(void* reserved)
+void SaveCallback(void* /*reserved*/)
 {
     _MESSAGE("Saving keyword data...");
     KeywordManager::GetSingleton()->Save(g_serialization);
     _MESSAGE("Save complete");
 }
 
-void LoadCallback(void* reserved)
+void LoadCallback(void* /*reserved*/)
 {
     _MESSAGE("Loading keyword data...");
+    auto start = std::chrono::steady_clock::now();
+    RebuildBaselineIfMapperWasNotReady();
+
+    // The save only holds runtime changes, which apply on top of the INI
+    // layer built at startup
+    KeywordManager::GetSingleton()->ClearRuntimeKeywords();
     KeywordManager::GetSingleton()->Load(g_serialization);
+    KeywordManager::GetSingleton()->LogMemoryStats();
 
-    _MESSAGE("Applying INI keywords...");
-    if (!EditorIDMapper::IsReady())
-        _WARNING("EditorIDMapper not ready  editor ID lookups will fail");
+    // Subscribers see the load as a single reset
+    KeywordChangeLog::Flush();
 
-    INILoader::LoadAll();
-    _MESSAGE("Load complete");
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _MESSAGE("Load complete in %.1f ms", ms);
 }
 
-void NewGameCallback(void* reserved)
+void NewGameCallback(void* /*reserved*/)
 {
     _MESSAGE("New game started - clearing runtime keywords");
+    RebuildBaselineIfMapperWasNotReady();
     KeywordManager::GetSingleton()->NewGame();
-
-    _MESSAGE("Applying INI keywords...");
-    INILoader::LoadAll();
+    KeywordChangeLog::Flush();
 }
 
 extern "C" {
@@ -210,6 +573,17 @@ extern "C" {
         obse->RegisterCommand(&kCommandInfo_PrintKeywordsRef);
         obse->RegisterCommand(&kCommandInfo_LoadKeywordsFromINI);
         obse->RegisterCommand(&kCommandInfo_ReloadKeywordINIs);
+        obse->RegisterCommand(&kCommandInfo_PrintKeywordStats);
+        obse->RegisterCommand(&kCommandInfo_GetKeywordHandle);
+        obse->RegisterCommand(&kCommandInfo_HasKeywordH);
+        obse->RegisterCommand(&kCommandInfo_HasKeywordHRef);
+        obse->RegisterCommand(&kCommandInfo_HasAnyKeywordH);
+        obse->RegisterCommand(&kCommandInfo_HasAnyKeywordHRef);
+        obse->RegisterCommand(&kCommandInfo_HasAllKeywordsH);
+        obse->RegisterCommand(&kCommandInfo_HasAllKeywordsHRef);
+        obse->RegisterCommand(&kCommandInfo_HasKeywordExpr);
+        obse->RegisterCommand(&kCommandInfo_HasKeywordExprRef);
+        obse->RegisterTypedCommand(&kCommandInfo_GetFormsWithKeywords, kRetnType_Array);
         _MESSAGE("Commands registered with opcode base 0x2760");
 
         if (obse->isEditor)
@@ -231,10 +605,17 @@ extern "C" {
             return false;
         }
         g_serialization->SetSaveCallback(g_pluginHandle, SaveCallback);
+        g_serialization->SetLoadCallback(g_pluginHandle, LoadCallback);
         g_serialization->SetNewGameCallback(g_pluginHandle, NewGameCallback);
 
         g_messaging = (OBSEMessagingInterface*)obse->QueryInterface(kInterface_Messaging);
 
+        g_arrayInterface = (OBSEArrayVarInterface*)obse->QueryInterface(kInterface_ArrayVar);
+        if (!g_arrayInterface)
+        {
+            _WARNING("Array interface not found - GetFormsWithKeywords will return nothing");
+        }
+
         g_messaging->RegisterListener(g_pluginHandle, "OBSE", OBSEMessageHandler);
 
         _MESSAGE("OBSEKeywords loaded successfully");
@@ -0,0 +1,13 @@
+#pragma once
+
+// ============================================================
+//  Allocation counting for the benchmarks
+//
+//  AllocationCount.cpp replaces the global operator new and
+//  delete.  It is its own translation unit so the compiler never
+//  inlines the replacements into library code that it assumes
+//  uses the standard ones.
+// ============================================================
+
+// Calls to operator new so far, on any thread
+UInt64 GetAllocationCount();
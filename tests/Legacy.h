@@ -0,0 +1,244 @@
+#pragma once
+
+#include "obse/PluginAPI.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ============================================================
+//  The original keyword store, co-save format and INI line
+//  parser, kept as they were for the tests and benchmarks to
+//  compare against.  Logging is left out.
+// ============================================================
+
+namespace Legacy
+{
+    class KeywordStore
+    {
+    public:
+        std::map<UInt32, std::set<std::string>> formKeywords;
+        std::map<std::string, std::set<UInt32>> keywordForms;
+
+        bool AddKeyword(UInt32 formID, const std::string& keyword)
+        {
+            if (keyword.empty()) return false;
+
+            std::string lowerKeyword = keyword;
+            std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+
+            formKeywords[formID].insert(lowerKeyword);
+            keywordForms[lowerKeyword].insert(formID);
+            return true;
+        }
+
+        bool RemoveKeyword(UInt32 formID, const std::string& keyword)
+        {
+            std::string lowerKeyword = keyword;
+            std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+
+            auto formIt = formKeywords.find(formID);
+            if (formIt != formKeywords.end())
+            {
+                formIt->second.erase(lowerKeyword);
+                if (formIt->second.empty()) formKeywords.erase(formIt);
+            }
+
+            auto keywordIt = keywordForms.find(lowerKeyword);
+            if (keywordIt != keywordForms.end())
+            {
+                keywordIt->second.erase(formID);
+                if (keywordIt->second.empty()) keywordForms.erase(keywordIt);
+            }
+            return true;
+        }
+
+        bool HasKeyword(UInt32 formID, const std::string& keyword)
+        {
+            std::string lowerKeyword = keyword;
+            std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+
+            auto it = formKeywords.find(formID);
+            if (it != formKeywords.end())
+            {
+                return it->second.find(lowerKeyword) != it->second.end();
+            }
+            return false;
+        }
+
+        std::vector<UInt32> GetFormsWithKeyword(const std::string& keyword)
+        {
+            std::vector<UInt32> result;
+            std::string lowerKeyword = keyword;
+            std::transform(lowerKeyword.begin(), lowerKeyword.end(), lowerKeyword.begin(), ::tolower);
+
+            auto it = keywordForms.find(lowerKeyword);
+            if (it != keywordForms.end())
+            {
+                result.assign(it->second.begin(), it->second.end());
+            }
+            return result;
+        }
+
+        void Clear()
+        {
+            formKeywords.clear();
+            keywordForms.clear();
+        }
+
+        // Version 1 co-save: KWCT, then per form KWFM + KWKC and a KWKL +
+        // KWKD pair per keyword
+        void Save(OBSESerializationInterface* intfc)
+        {
+            UInt32 numForms = formKeywords.size();
+            intfc->WriteRecord('KWCT', 1, &numForms, sizeof(numForms));
+
+            for (const auto& pair : formKeywords)
+            {
+                UInt32 formID = pair.first;
+                UInt32 numKeywords = pair.second.size();
+
+                intfc->WriteRecord('KWFM', 1, &formID, sizeof(formID));
+                intfc->WriteRecord('KWKC', 1, &numKeywords, sizeof(numKeywords));
+
+                for (const auto& keyword : pair.second)
+                {
+                    UInt32 keywordLen = keyword.length();
+                    intfc->WriteRecord('KWKL', 1, &keywordLen, sizeof(keywordLen));
+                    intfc->WriteRecord('KWKD', 1, keyword.c_str(), keywordLen);
+                }
+            }
+        }
+
+        void Load(OBSESerializationInterface* intfc)
+        {
+            Clear();
+
+            UInt32 type, version, length;
+            while (intfc->GetNextRecordInfo(&type, &version, &length))
+            {
+                switch (type)
+                {
+                case 'KWCT':
+                {
+                    UInt32 numForms;
+                    intfc->ReadRecordData(&numForms, sizeof(numForms));
+                    break;
+                }
+
+                case 'KWFM':
+                {
+                    UInt32 oldFormID, newFormID;
+                    intfc->ReadRecordData(&oldFormID, sizeof(oldFormID));
+                    if (!intfc->ResolveRefID(oldFormID, &newFormID))
+                    {
+                        newFormID = oldFormID;
+                    }
+
+                    if (intfc->GetNextRecordInfo(&type, &version, &length) && type == 'KWKC')
+                    {
+                        UInt32 numKeywords;
+                        intfc->ReadRecordData(&numKeywords, sizeof(numKeywords));
+
+                        for (UInt32 i = 0; i < numKeywords; i++)
+                        {
+                            if (intfc->GetNextRecordInfo(&type, &version, &length) && type == 'KWKL')
+                            {
+                                UInt32 keywordLen;
+                                intfc->ReadRecordData(&keywordLen, sizeof(keywordLen));
+
+                                if (intfc->GetNextRecordInfo(&type, &version, &length) && type == 'KWKD')
+                                {
+                                    char* buffer = new char[keywordLen + 1];
+                                    intfc->ReadRecordData(buffer, keywordLen);
+                                    buffer[keywordLen] = '\0';
+
+                                    std::string keyword(buffer);
+                                    AddKeyword(newFormID, keyword);
+
+                                    delete[] buffer;
+                                }
+                            }
+                        }
+                    }
+                    break;
+                }
+                }
+            }
+        }
+    };
+
+    inline void Trim(std::string& s)
+    {
+        s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char c) {
+            return !std::isspace(c);
+            }));
+        s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char c) {
+            return !std::isspace(c);
+            }).base(), s.end());
+    }
+
+    inline void StripComment(std::string& s)
+    {
+        for (std::size_t i = 0; i < s.size(); ++i)
+        {
+            if (s[i] == ';' || s[i] == '#')
+            {
+                s.erase(i);
+                return;
+            }
+        }
+    }
+
+    inline bool ParseLine(const std::string& rawLine, std::string& outToken, std::vector<std::string>& outKeywords)
+    {
+        outToken.clear();
+        outKeywords.clear();
+
+        std::string line = rawLine;
+        StripComment(line);
+        Trim(line);
+
+        if (line.empty()) return false;
+        if (line.front() == '[') return false;
+
+        auto eq = line.find('=');
+        if (eq == std::string::npos) return false;
+
+        outToken = line.substr(0, eq);
+        Trim(outToken);
+        if (outToken.empty()) return false;
+
+        std::string keywordPart = line.substr(eq + 1);
+
+        std::stringstream ss(keywordPart);
+        std::string kw;
+        while (std::getline(ss, kw, ','))
+        {
+            Trim(kw);
+            if (!kw.empty())
+            {
+                outKeywords.push_back(kw);
+            }
+        }
+        return !outKeywords.empty();
+    }
+
+    // Reads a file the way LoadFile did and returns its number of keywords
+    inline UInt32 ParseFile(const std::string& path)
+    {
+        std::ifstream file(path);
+        std::string line, token;
+        std::vector<std::string> keywords;
+        UInt32 numKeywords = 0;
+        while (std::getline(file, line))
+        {
+            if (ParseLine(line, token, keywords)) numKeywords += keywords.size();
+        }
+        return numKeywords;
+    }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "obse/PluginAPI.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// ============================================================
+//  In-memory co-save behind an OBSESerializationInterface
+//
+//  Records are kept as written.  Bytes() counts each record's
+//  payload plus the 12-byte type / version / length header the
+//  co-save stores for it.  ResolveRefID passes form IDs through
+//  resolve, which keeps them as they are by default.
+// ============================================================
+
+class MockSerialization
+{
+public:
+    struct Record
+    {
+        UInt32             type;
+        UInt32             version;
+        std::vector<UInt8> data;
+    };
+
+    std::vector<Record>                 records;
+    std::function<UInt32(UInt32)>       resolve = [](UInt32 refID) { return refID; };
+
+    MockSerialization()
+    {
+        intfc.version = OBSESerializationInterface::kVersion;
+        intfc.WriteRecord = &MockSerialization::WriteRecord;
+        intfc.OpenRecord = &MockSerialization::OpenRecord;
+        intfc.WriteRecordData = &MockSerialization::WriteRecordData;
+        intfc.GetNextRecordInfo = &MockSerialization::GetNextRecordInfo;
+        intfc.ReadRecordData = &MockSerialization::ReadRecordData;
+        intfc.ResolveRefID = &MockSerialization::ResolveRefID;
+    }
+
+    // The interface, reading from and writing to this co-save.  Only one
+    // mock is active at a time.
+    OBSESerializationInterface* Interface()
+    {
+        Active() = this;
+        return &intfc;
+    }
+
+    // Starts reading from the first record again
+    void Rewind()
+    {
+        nextRecord = 0;
+        readRecord = nullptr;
+        readPos = 0;
+    }
+
+    void Clear()
+    {
+        records.clear();
+        Rewind();
+    }
+
+    UInt32 Bytes() const
+    {
+        UInt32 bytes = 0;
+        for (const auto& record : records)
+        {
+            bytes += 12 + record.data.size();
+        }
+        return bytes;
+    }
+
+private:
+    OBSESerializationInterface intfc = {};
+    std::size_t                nextRecord = 0;
+    Record*                    readRecord = nullptr;
+    std::size_t                readPos = 0;
+
+    static MockSerialization*& Active()
+    {
+        static MockSerialization* active = nullptr;
+        return active;
+    }
+
+    static bool WriteRecord(UInt32 type, UInt32 version, const void* buf, UInt32 length)
+    {
+        return OpenRecord(type, version) && WriteRecordData(buf, length);
+    }
+
+    static bool OpenRecord(UInt32 type, UInt32 version)
+    {
+        Active()->records.push_back({ type, version, {} });
+        return true;
+    }
+
+    static bool WriteRecordData(const void* buf, UInt32 length)
+    {
+        std::vector<UInt8>& data = Active()->records.back().data;
+        data.insert(data.end(), static_cast<const UInt8*>(buf), static_cast<const UInt8*>(buf) + length);
+        return true;
+    }
+
+    static bool GetNextRecordInfo(UInt32* type, UInt32* version, UInt32* length)
+    {
+        MockSerialization* self = Active();
+        if (self->nextRecord >= self->records.size()) return false;
+
+        self->readRecord = &self->records[self->nextRecord++];
+        self->readPos = 0;
+        *type = self->readRecord->type;
+        *version = self->readRecord->version;
+        *length = self->readRecord->data.size();
+        return true;
+    }
+
+    static UInt32 ReadRecordData(void* buf, UInt32 length)
+    {
+        MockSerialization* self = Active();
+        if (!self->readRecord) return 0;
+
+        std::size_t available = self->readRecord->data.size() - self->readPos;
+        UInt32 count = static_cast<UInt32>(std::min<std::size_t>(length, available));
+        // buf may be null for an empty read, e.g. from an empty vector
+        if (count) std::memcpy(buf, self->readRecord->data.data() + self->readPos, count);
+        self->readPos += count;
+        return count;
+    }
+
+    static bool ResolveRefID(UInt32 refID, UInt32* outRefID)
+    {
+        *outRefID = Active()->resolve(refID);
+        return *outRefID != 0;
+    }
+};
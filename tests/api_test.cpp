@@ -0,0 +1,292 @@
+// The client header, KeywordAPI.h, against the plugin's message handler:
+// every call through messages and through the direct interface, and the
+// fallbacks for an OBSEKeywords too old for a message or interface field.
+
+#include "Keywords.h"
+#include "KeywordAPI.h"
+#include "TestSDK.h"
+
+#include <algorithm>
+#include <set>
+
+void KeywordMessageHandler(OBSEMessagingInterface::Message* msg);
+
+// Message types the simulated OBSEKeywords is too old to handle; OBSE still
+// delivers them, but nothing answers
+static std::set<UInt32> s_unhandled;
+
+static bool Dispatch(PluginHandle, UInt32 type, void* data, UInt32 dataLen, const char*)
+{
+    if (s_unhandled.count(type)) return true;
+
+    OBSEMessagingInterface::Message msg = { "OBSEKeywords", type, dataLen, data };
+    KeywordMessageHandler(&msg);
+    return true;
+}
+
+static const KeywordAPI::KeywordInterface* ServerInterface()
+{
+    KeywordAPI::GetInterfaceData data = { nullptr };
+    OBSEMessagingInterface::Message msg = { "test", KeywordAPI::kMessage_GetInterface, sizeof(data), &data };
+    KeywordMessageHandler(&msg);
+    return data.intfc;
+}
+
+static void Populate()
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+    for (UInt32 formID = 1; formID <= 100; ++formID)
+    {
+        for (UInt32 k = 0; k < 10; ++k)
+        {
+            if ((formID >> (k % 7)) & 1) mgr->AddKeyword(formID, "Kw" + std::to_string(k));
+        }
+    }
+}
+
+// Runs the calls every client can make, against the manager's own answers
+static void CheckClientCalls(const char* what)
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    int failuresBefore = TestSDK::Failures();
+
+    for (UInt32 formID = 1; formID <= 100; ++formID)
+    {
+        CHECK(KeywordAPI::HasKeyword(formID, "KW3") == mgr->HasKeyword(formID, "kw3"));
+        CHECK(KeywordAPI::GetKeywordCount(formID) == (UInt32)mgr->GetKeywordCount(formID));
+        CHECK(KeywordAPI::GetNthKeyword(formID, 0) == std::string(mgr->GetNthKeyword(formID, 0)));
+
+        std::vector<std::string> expected = mgr->GetKeywords(formID);
+        std::vector<const char*> names = KeywordAPI::GetKeywords(formID);
+        CHECK(std::equal(names.begin(), names.end(), expected.begin(), expected.end()));
+
+        bool has1 = mgr->HasKeyword(formID, "Kw1"), has2 = mgr->HasKeyword(formID, "Kw2");
+        CHECK(KeywordAPI::HasAnyKeyword(formID, "Kw1", "Kw2") == (has1 || has2));
+        CHECK(KeywordAPI::HasAllKeywords(formID, "Kw1", "Kw2") == (has1 && has2));
+        CHECK(KeywordAPI::HasKeywordExpr(formID, "Kw1 & !Kw2") == (has1 && !has2));
+
+        // More keywords than the four kMessage_HasAny / HasAll take; all
+        // leaves out the last, which no form has
+        const char* keywords[] = { "Kw0", "Kw1", "", "Kw2", "Kw3", nullptr, "Kw4", "Kw5", "Kw6", "Unknown" };
+        bool any = false, all = true;
+        for (UInt32 i = 0; i < 9; ++i)
+        {
+            if (!keywords[i] || !keywords[i][0]) continue;
+            bool has = mgr->HasKeyword(formID, keywords[i]);
+            any = any || has;
+            all = all && has;
+        }
+        CHECK(KeywordAPI::HasKeywordList(formID, keywords, 10, KeywordAPI::kMatch_Any) == any);
+        CHECK(KeywordAPI::HasKeywordList(formID, keywords, 9, KeywordAPI::kMatch_All) == all);
+        CHECK(!KeywordAPI::HasKeywordList(formID, keywords, 10, KeywordAPI::kMatch_All));
+        CHECK(KeywordAPI::HasKeywordList(formID, keywords, 10, KeywordAPI::kMatch_None) == !any);
+    }
+
+    std::vector<UInt32> found = KeywordAPI::FindForms("Kw0 & Kw6");
+    std::vector<UInt32> expected;
+    for (UInt32 formID = 1; formID <= 100; ++formID)
+    {
+        if (mgr->HasKeyword(formID, "Kw0") && mgr->HasKeyword(formID, "Kw6")) expected.push_back(formID);
+    }
+    CHECK(found == expected);
+
+    // Writes
+    CHECK(KeywordAPI::AddKeyword(500, "Added"));
+    CHECK(mgr->HasKeyword(500, "added"));
+    CHECK(KeywordAPI::RemoveKeyword(500, "Added"));
+    CHECK(!mgr->HasKeyword(500, "added"));
+    KeywordAPI::ClearKeywords(7);
+    CHECK(mgr->GetKeywordCount(7) == 0);
+    Populate();
+
+    if (TestSDK::Failures() != failuresBefore)
+    {
+        std::fprintf(stderr, "  (client calls %s)\n", what);
+    }
+}
+
+static void TestClient()
+{
+    static OBSEMessagingInterface messaging = {};
+    messaging.Dispatch = Dispatch;
+
+    // Not ready: nothing is sent
+    KeywordAPI::Init(&messaging, 1);
+    CHECK(!KeywordAPI::AddKeyword(1, "Early"));
+    CHECK(!KeywordAPI::HasKeyword(1, "Early"));
+
+    KeywordAPI::s_ready = true;
+    Populate();
+
+    CheckClientCalls("through messages");
+
+    const KeywordAPI::KeywordInterface* intfc = KeywordAPI::GetInterface();
+    CHECK(intfc && intfc->version == KeywordAPI::kInterfaceVersion);
+    CHECK(intfc && intfc->size == sizeof(KeywordAPI::KeywordInterface));
+    CheckClientCalls("through the interface");
+
+    // A table too short for version 1 is ignored
+    KeywordAPI::KeywordInterface truncated = *intfc;
+    truncated.size = offsetof(KeywordAPI::KeywordInterface, GetKeywordHandles);
+    KeywordAPI::s_interface = nullptr;
+    KeywordAPI::SetInterface(&truncated);
+    CHECK(KeywordAPI::s_interface == nullptr);
+
+    // A version 2 table and a server without kMessage_GetKeywords or
+    // kMessage_HasKeywordList: GetKeywords falls back to GetNthKeyword and
+    // HasKeywordList to groups of four
+    KeywordAPI::KeywordInterface version2 = *intfc;
+    version2.version = 2;
+    version2.GetKeywordNames = nullptr;
+    version2.HasKeywordList = nullptr;
+    KeywordAPI::SetInterface(&version2);
+    s_unhandled = { KeywordAPI::kMessage_GetKeywords, KeywordAPI::kMessage_HasKeywordList };
+    CheckClientCalls("against a version 2 interface");
+    CHECK(!KeywordAPI::s_keywordNameCopies.empty());
+
+    KeywordAPI::s_interface = nullptr;
+    s_unhandled.insert(KeywordAPI::kMessage_GetInterface);
+    CHECK(KeywordAPI::GetInterface() == nullptr);
+    CheckClientCalls("against an old server");
+
+    s_unhandled.clear();
+    KeywordAPI::s_interface = nullptr;
+}
+
+static void TestBatch()
+{
+    Populate();
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+
+    std::vector<UInt32> formIDs;
+    for (UInt32 formID = 0; formID <= 120; formID += 3) formIDs.push_back(formID);
+    const char* keywords[] = { "Kw0", nullptr, "KW5", "Unknown", "Kw9" };
+    const UInt32 numKeywords = 5;
+
+    std::vector<UInt8> results(formIDs.size() * numKeywords, 0xFF);
+    std::vector<UInt64> masks(formIDs.size(), ~0ull);
+    KeywordAPI::BatchData batch = { formIDs.data(), (UInt32)formIDs.size(), keywords, nullptr, numKeywords,
+        results.data(), masks.data(), false };
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        // Through the message, then the interface
+        if (pass == 1) KeywordAPI::SetInterface(ServerInterface());
+        CHECK(KeywordAPI::HasKeywordsBatch(batch));
+
+        for (std::size_t f = 0; f < formIDs.size(); ++f)
+        {
+            UInt64 mask = 0;
+            for (UInt32 k = 0; k < numKeywords; ++k)
+            {
+                bool has = keywords[k] && mgr->HasKeyword(formIDs[f], keywords[k]);
+                CHECK(results[f * numKeywords + k] == has);
+                mask |= static_cast<UInt64>(has) << k;
+            }
+            CHECK(masks[f] == mask);
+        }
+    }
+
+    // By handle
+    const KeywordAPI::KeywordInterface* intfc = KeywordAPI::GetInterface();
+    UInt32 handles[] = { intfc->GetKeywordHandle("kw2"), 0, intfc->GetKeywordHandle("Kw4") };
+    KeywordAPI::BatchData byHandle = { formIDs.data(), (UInt32)formIDs.size(), nullptr, handles, 3,
+        results.data(), nullptr, false };
+    CHECK(KeywordAPI::HasKeywordsBatch(byHandle));
+    for (std::size_t f = 0; f < formIDs.size(); ++f)
+    {
+        CHECK(results[f * 3 + 0] == mgr->HasKeyword(formIDs[f], "Kw2"));
+        CHECK(results[f * 3 + 1] == 0);
+        CHECK(results[f * 3 + 2] == mgr->HasKeyword(formIDs[f], "Kw4"));
+    }
+
+    // Malformed batches are left unhandled: null arrays with a nonzero count,
+    // or a message too short for BatchData
+    KeywordAPI::BatchData noForms = { nullptr, 4, keywords, nullptr, numKeywords, results.data(), nullptr, false };
+    CHECK(!KeywordAPI::HasKeywordsBatch(noForms));
+    KeywordAPI::BatchData noKeywords = { formIDs.data(), 4, nullptr, nullptr, 2, results.data(), nullptr, false };
+    CHECK(!KeywordAPI::HasKeywordsBatch(noKeywords));
+    intfc->HasKeywordsBatch(nullptr);
+
+    KeywordAPI::BatchData shortMessage = batch;
+    shortMessage.handled = false;
+    OBSEMessagingInterface::Message msg = { "test", KeywordAPI::kMessage_HasBatch,
+        offsetof(KeywordAPI::BatchData, handled), &shortMessage };
+    KeywordMessageHandler(&msg);
+    CHECK(!shortMessage.handled);
+    msg.data = nullptr;
+    msg.dataLen = 0;
+    KeywordMessageHandler(&msg);
+
+    KeywordAPI::s_interface = nullptr;
+}
+
+struct Received
+{
+    std::vector<KeywordAPI::KeywordChange> changes;
+    UInt32 resetReasons = 0;
+    int    batches = 0;
+};
+
+static void OnChanges(const KeywordAPI::ChangeBatch* batch, void* context)
+{
+    Received* received = static_cast<Received*>(context);
+    ++received->batches;
+    received->resetReasons |= batch->resetReasons;
+    received->changes.insert(received->changes.end(), batch->changes, batch->changes + batch->numChanges);
+}
+
+static void TestSubscriptions()
+{
+    Populate();
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    UInt32 target = mgr->InternKeyword("Target");
+
+    Received all, byForm;
+    UInt32 allID = KeywordAPI::Subscribe(OnChanges, &all);
+    UInt32 form5 = 5;
+    UInt32 byFormID = KeywordAPI::Subscribe(OnChanges, &byForm, &form5, 1);
+    CHECK(allID && byFormID && allID != byFormID);
+
+    KeywordAPI::FlushChanges();
+    CHECK(all.batches == 0);
+
+    mgr->AddKeyword(5, "Target");
+    mgr->AddKeyword(6, "Temporary");     // added and removed: nothing to report
+    mgr->RemoveKeyword(6, "Temporary");
+    mgr->RemoveKeyword(3, "Kw0");
+    KeywordAPI::FlushChanges();
+
+    CHECK(all.batches == 1 && all.changes.size() == 2);
+    if (all.changes.size() == 2)
+    {
+        CHECK(all.changes[0].formID == 3 && !all.changes[0].added);
+        CHECK(all.changes[1].formID == 5 && all.changes[1].added && all.changes[1].handle == target);
+    }
+    CHECK(byForm.batches == 1 && byForm.changes.size() == 1);
+
+    // Bulk operations report a reset instead of each change
+    mgr->NewGame();
+    KeywordAPI::FlushChanges();
+    CHECK(all.resetReasons & KeywordAPI::kReset_Game);
+
+    CHECK(KeywordAPI::Unsubscribe(allID));
+    CHECK(!KeywordAPI::Unsubscribe(allID));
+    CHECK(KeywordAPI::Unsubscribe(byFormID));
+}
+
+int main()
+{
+    TestClient();
+    TestBatch();
+    TestSubscriptions();
+
+    if (TestSDK::Failures())
+    {
+        std::fprintf(stderr, "api_test: %d check(s) failed\n", TestSDK::Failures());
+        return 1;
+    }
+    std::printf("api_test: ok\n");
+    return 0;
+}
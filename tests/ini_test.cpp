@@ -0,0 +1,306 @@
+// The INI pipeline: the line parser, ParseFiles against ParseFile, the
+// INICache (parsed files and the resolved table), ReloadChanged against a
+// full rebuild, and editor IDs seen before EditorIDMapper is ready.
+
+#include "Keywords.h"
+#include "INIParser.h"
+#include "TestSDK.h"
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+
+typedef std::set<std::pair<UInt32, std::string>> Snapshot;
+
+static UInt32 FormOf(const std::string& editorID)
+{
+    return TestSDK::EditorFormID(editorID);
+}
+
+// The (form, keyword) pairs of the given forms, names folded to lower case
+static Snapshot TakeSnapshot(const std::set<UInt32>& formIDs)
+{
+    Snapshot snapshot;
+    for (UInt32 formID : formIDs)
+    {
+        for (std::string keyword : KeywordManager::GetSingleton()->GetKeywords(formID))
+        {
+            for (char& c : keyword) c = FoldKeywordChar(c);
+            snapshot.insert({ formID, keyword });
+        }
+    }
+    return snapshot;
+}
+
+static std::vector<INILoadResult> LoadAll()
+{
+    std::vector<INILoadResult> results;
+    TestSDK::ClearLog();
+    KeywordManager::GetSingleton()->BuildBaseline([&results] { results = INILoader::LoadAll(); });
+    return results;
+}
+
+static bool UsedResolvedCache()
+{
+    return TestSDK::LogContains("from the resolved cache");
+}
+
+static void TestParseFile()
+{
+    TestSDK::ResetINIDirectory();
+    TestSDK::WriteINIFile("parse.ini",
+        "; comment\n"
+        "# hash comment\n"
+        "[Weapons]\n"
+        "\n"
+        "WeapIronDagger = Weapon, Blade ,OneHanded ; trailing comment\r\n"
+        "  Spaced Token  =  Two Words,, Other  \n"
+        "no equals sign\n"
+        " = Orphan\n"
+        "EmptyList = , ,\n"
+        "0x000800~Oblivion.esm = Hex");
+
+    INIParsedFile file = INILoader::ParseFile(INILoader::GetINIDirectory() + "parse.ini");
+    CHECK(file.opened);
+    CHECK(file.lines.size() == 6);
+    if (file.lines.size() != 6) return;
+
+    auto keywordsOf = [&file](const INIParsedLine& line) {
+        return std::vector<std::string>(file.keywords.begin() + line.firstKeyword,
+            file.keywords.begin() + line.firstKeyword + line.numKeywords);
+    };
+
+    CHECK(file.lines[0].lineNum == 5 && file.lines[0].token == "WeapIronDagger");
+    CHECK(keywordsOf(file.lines[0]) == (std::vector<std::string>{ "Weapon", "Blade", "OneHanded" }));
+    CHECK(file.lines[1].token == "Spaced Token");
+    CHECK(keywordsOf(file.lines[1]) == (std::vector<std::string>{ "Two Words", "Other" }));
+    CHECK(file.lines[2].lineNum == 7 && file.lines[2].error.find("no '=' found") == 0);
+    CHECK(file.lines[3].error.find("empty form token") == 0);
+    CHECK(file.lines[4].error.find("no keywords found") == 0);
+    CHECK(file.lines[5].token == "0x000800~Oblivion.esm" && file.lines[5].error.empty());
+
+    CHECK(!INILoader::ParseFile(INILoader::GetINIDirectory() + "missing.ini").opened);
+
+    // Applied: errors are counted, every good line resolves
+    std::vector<INILoadResult> results = LoadAll();
+    CHECK(results.size() == 1);
+    CHECK(results[0].formsProcessed == 3 && results[0].keywordsAdded == 6 && results[0].errorLines == 3);
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    CHECK(mgr->HasKeyword(FormOf("WeapIronDagger"), "oneHanded"));
+    CHECK(mgr->HasKeyword(FormOf("Spaced Token"), "two words"));
+    CHECK(mgr->HasKeyword(0x00000800, "Hex"));
+}
+
+// Random files: form tokens from a pool of editor IDs (and some that do not
+// resolve), a few malformed lines, keywords from a fixed vocabulary
+static std::set<UInt32> WriteCorpus(std::mt19937& rng, int numFiles, int linesPerFile)
+{
+    std::set<UInt32> formIDs;
+    for (int f = 0; f < numFiles; ++f)
+    {
+        std::string text = "; generated\n[Section]\n";
+        for (int l = 0; l < linesPerFile; ++l)
+        {
+            if (rng() % 50 == 0)
+            {
+                text += "malformed line\n";
+                continue;
+            }
+
+            std::string editorID = (rng() % 40 == 0 ? "Missing" : "Form") + std::to_string(rng() % 5000);
+            formIDs.insert(FormOf(editorID));
+            text += editorID + " = ";
+            for (int k = 0, n = 1 + rng() % 5; k < n; ++k)
+            {
+                text += (k ? ", Kw" : "Kw") + std::to_string(rng() % 300);
+            }
+            text += '\n';
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), "corpus%02d.ini", f);
+        TestSDK::WriteINIFile(name, text);
+    }
+    return formIDs;
+}
+
+static void TestParseFiles()
+{
+    TestSDK::ResetINIDirectory();
+    std::mt19937 rng(7);
+    WriteCorpus(rng, 12, 400);
+
+    std::vector<std::string> paths;
+    for (int f = 0; f < 12; ++f)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "corpus%02d.ini", f);
+        paths.push_back(INILoader::GetINIDirectory() + name);
+    }
+
+    std::vector<INIParsedFile> parallel = INILoader::ParseFiles(paths);
+    CHECK(parallel.size() == paths.size());
+    for (std::size_t f = 0; f < paths.size() && f < parallel.size(); ++f)
+    {
+        INIParsedFile sequential = INILoader::ParseFile(paths[f]);
+        CHECK(parallel[f].path == paths[f]);
+        CHECK(parallel[f].contentHash == sequential.contentHash);
+        CHECK(parallel[f].lines.size() == sequential.lines.size());
+        CHECK(std::equal(parallel[f].keywords.begin(), parallel[f].keywords.end(),
+            sequential.keywords.begin(), sequential.keywords.end()));
+    }
+}
+
+static void TestCache()
+{
+    TestSDK::ResetINIDirectory();
+    TestSDK::SetModList({ "Oblivion.esm" });
+    std::mt19937 rng(11);
+    std::set<UInt32> formIDs = WriteCorpus(rng, 8, 500);
+
+    // Cold: everything parsed and resolved
+    std::vector<INILoadResult> cold = LoadAll();
+    CHECK(!UsedResolvedCache());
+    Snapshot expected = TakeSnapshot(formIDs);
+    CHECK(!expected.empty());
+
+    // The corpus has lines that do not resolve, so no table is cached and
+    // the parsed files are reused instead
+    std::vector<INILoadResult> warm = LoadAll();
+    CHECK(!UsedResolvedCache());
+    CHECK(TestSDK::LogContains("8 file(s) from cache, parsed 0"));
+    CHECK(TakeSnapshot(formIDs) == expected);
+
+    // Without unresolved lines the second load applies the resolved table
+    TestSDK::ResetINIDirectory();
+    std::string text;
+    for (int i = 0; i < 300; ++i)
+    {
+        text += "Item" + std::to_string(i) + " = Kw" + std::to_string(i % 17) + ", Shared\n";
+        formIDs.insert(FormOf("Item" + std::to_string(i)));
+    }
+    TestSDK::WriteINIFile("a.ini", text + "bad line\n");
+    TestSDK::WriteINIFile("b.ini", "Item0 = Extra\nItem1 = Kw3\n");
+
+    cold = LoadAll();
+    CHECK(!UsedResolvedCache());
+    expected = TakeSnapshot(formIDs);
+
+    // Keywords interned in another order must not matter
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    for (int k = 16; k >= 0; --k)
+    {
+        mgr->InternKeyword("Unrelated" + std::to_string(k));
+    }
+
+    warm = LoadAll();
+    CHECK(UsedResolvedCache());
+    CHECK(TakeSnapshot(formIDs) == expected);
+    CHECK(warm.size() == cold.size());
+    for (std::size_t f = 0; f < warm.size() && f < cold.size(); ++f)
+    {
+        CHECK(warm[f].filePath == cold[f].filePath);
+        CHECK(warm[f].formsProcessed == cold[f].formsProcessed);
+        CHECK(warm[f].keywordsAdded == cold[f].keywordsAdded);
+        CHECK(warm[f].errorLines == cold[f].errorLines);
+    }
+    CHECK(TestSDK::LogContains("line 301: no '=' found"));
+
+    // Runtime edits stay on top of the INI layer applied from the table
+    mgr->AddKeyword(FormOf("Item5"), "RuntimeOnly");
+    LoadAll();
+    CHECK(UsedResolvedCache());
+    CHECK(mgr->HasKeyword(FormOf("Item5"), "RuntimeOnly"));
+    mgr->ClearRuntimeKeywords();
+
+    // A load order change invalidates the resolved form IDs
+    TestSDK::SetModList({ "Oblivion.esm", "Other.esp" });
+    LoadAll();
+    CHECK(!UsedResolvedCache());
+    LoadAll();
+    CHECK(UsedResolvedCache());
+    CHECK(TakeSnapshot(formIDs) == expected);
+
+    // A cache cut off inside the resolved table is ignored
+    {
+        std::string path = INILoader::GetCachePath();
+        std::ifstream in(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        bytes.resize(16);
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+    }
+    LoadAll();
+    CHECK(!UsedResolvedCache());
+    CHECK(TestSDK::LogContains("is corrupt, ignoring it"));
+    CHECK(TakeSnapshot(formIDs) == expected);
+}
+
+static void TestReloadChanged()
+{
+    TestSDK::ResetINIDirectory();
+    TestSDK::SetModList({ "Oblivion.esm" });
+    std::mt19937 rng(23);
+    std::set<UInt32> formIDs = WriteCorpus(rng, 6, 300);
+    LoadAll();
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->AddKeyword(FormOf("Form1"), "RuntimeOnly");
+
+    // Edit one file, delete one, add one
+    TestSDK::WriteINIFile("corpus01.ini", "Form1 = Brand New, Kw1\nForm2 = Kw2\n");
+    TestSDK::DeleteINIFile("corpus03.ini");
+    TestSDK::WriteINIFile("zz_added.ini", "Form3 = Added\n");
+    formIDs.insert({ FormOf("Form1"), FormOf("Form2"), FormOf("Form3") });
+
+    TestSDK::ClearLog();
+    std::vector<INILoadResult> reloaded = INILoader::ReloadChanged();
+    CHECK(reloaded.size() == 2);
+    CHECK(TestSDK::LogContains("was removed"));
+    Snapshot incremental = TakeSnapshot(formIDs);
+    CHECK(mgr->HasKeyword(FormOf("Form1"), "brand new"));
+    CHECK(mgr->HasKeyword(FormOf("Form3"), "added"));
+
+    LoadAll();
+    CHECK(TakeSnapshot(formIDs) == incremental);
+    mgr->ClearRuntimeKeywords();
+}
+
+static void TestMapperNotReady()
+{
+    TestSDK::ResetINIDirectory();
+    TestSDK::WriteINIFile("early.ini", "EarlyForm = Early\n0x000801~Oblivion.esm = ByFormID\n");
+
+    TestSDK::SetMapperReady(false);
+    LoadAll();
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    CHECK(INILoader::GetUnreadyMisses() == 1);
+    CHECK(!mgr->HasKeyword(FormOf("EarlyForm"), "Early"));
+    CHECK(mgr->HasKeyword(0x00000801, "ByFormID"));
+
+    // Misses before the mapper is ready are neither cached nor kept, so the
+    // next load resolves them
+    TestSDK::SetMapperReady(true);
+    LoadAll();
+    CHECK(INILoader::GetUnreadyMisses() == 0);
+    CHECK(mgr->HasKeyword(FormOf("EarlyForm"), "Early"));
+}
+
+int main()
+{
+    TestParseFile();
+    TestParseFiles();
+    TestCache();
+    TestReloadChanged();
+    TestMapperNotReady();
+
+    if (TestSDK::Failures())
+    {
+        std::fprintf(stderr, "ini_test: %d check(s) failed\n", TestSDK::Failures());
+        return 1;
+    }
+    std::printf("ini_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,576 @@
+// Benchmarks for the keyword store, co-save and INI loader, each against
+// the implementation it replaced (Legacy.h) where there is one.
+//
+//   keyword_bench            full sizes; build with optimizations
+//   keyword_bench --quick    small sizes, as run by ctest
+
+#include "Keywords.h"
+#include "KeywordAPI.h"
+#include "INIParser.h"
+#include "FormMap.h"
+#include "Legacy.h"
+#include "MockSerialization.h"
+#include "AllocationCount.h"
+#include "TestSDK.h"
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <thread>
+
+// ============================================================
+//  Helpers
+// ============================================================
+
+static bool s_quick = false;
+// Results are summed here and printed at the end, so no call is optimized away
+static UInt64 s_sink = 0;
+
+// Best of reps runs of func, in milliseconds
+template <class Func>
+static double BestMs(int reps, Func&& func)
+{
+    double best = 1e300;
+    for (int r = 0; r < reps; ++r)
+    {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// Allocations made by one run of func
+template <class Func>
+static UInt64 CountAllocations(Func&& func)
+{
+    UInt64 before = GetAllocationCount();
+    func();
+    return GetAllocationCount() - before;
+}
+
+static void Section(const char* title)
+{
+    std::printf("\n== %s\n", title);
+}
+
+// ============================================================
+//  Allocations per lookup
+// ============================================================
+
+static void BenchLookupAllocations()
+{
+    Section("Lookup allocations: HasKeyword / RemoveKeyword / GetFormsWithKeyword");
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+    Legacy::KeywordStore legacy;
+
+    const char* shortKeyword = "Weapon";
+    const char* longKeyword = "OneHandedBladeWeapon";   // past the 15-character small string buffer
+    const UInt32 numForms = 1000;
+    for (UInt32 formID = 1; formID <= numForms; ++formID)
+    {
+        for (const char* keyword : { shortKeyword, longKeyword, "Iron", "Metal" })
+        {
+            mgr->AddKeyword(formID, keyword);
+            legacy.AddKeyword(formID, keyword);
+        }
+    }
+
+    const UInt32 calls = s_quick ? 20000 : 1000000;
+    auto report = [calls](const char* what, auto&& newCall, auto&& oldCall) {
+        UInt64 newAllocs = CountAllocations([&] { for (UInt32 i = 0; i < calls; ++i) newCall(i % numForms + 1); });
+        UInt64 oldAllocs = CountAllocations([&] { for (UInt32 i = 0; i < calls; ++i) oldCall(i % numForms + 1); });
+        double newMs = BestMs(3, [&] { for (UInt32 i = 0; i < calls; ++i) newCall(i % numForms + 1); });
+        double oldMs = BestMs(3, [&] { for (UInt32 i = 0; i < calls; ++i) oldCall(i % numForms + 1); });
+        std::printf("  %-36s new %6.2f allocs %7.1f ns | old %6.2f allocs %7.1f ns  (per call)\n", what,
+            (double)newAllocs / calls, newMs * 1e6 / calls, (double)oldAllocs / calls, oldMs * 1e6 / calls);
+    };
+
+    for (const char* keyword : { shortKeyword, longKeyword })
+    {
+        std::string label = std::string("HasKeyword \"") + keyword + "\"";
+        report(label.c_str(),
+            [&](UInt32 formID) { s_sink += mgr->HasKeyword(formID, keyword); },
+            [&](UInt32 formID) { s_sink += legacy.HasKeyword(formID, keyword); });
+    }
+
+    // A keyword the forms do not have, so every call does the same work
+    report("RemoveKeyword (absent)",
+        [&](UInt32 formID) { s_sink += mgr->RemoveKeyword(formID, "NotPresentKeyword"); },
+        [&](UInt32 formID) { s_sink += legacy.RemoveKeyword(formID, "NotPresentKeyword"); });
+
+    // The result vector is the one allocation either way
+    report("GetFormsWithKeyword \"Iron\"",
+        [&](UInt32) { s_sink += mgr->GetFormsWithKeyword("Iron").size(); },
+        [&](UInt32) { s_sink += legacy.GetFormsWithKeyword("Iron").size(); });
+}
+
+// ============================================================
+//  Any-of / all-of against a vocabulary of 2048
+// ============================================================
+
+static void BenchAnyAll()
+{
+    Section("HasAnyKeyword / HasAllKeywords, 2048 keyword vocabulary");
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+    Legacy::KeywordStore legacy;
+
+    const UInt32 numKeywords = 2048;
+    const UInt32 numForms = s_quick ? 2000 : 20000;
+    std::vector<std::string> names;
+    for (UInt32 k = 0; k < numKeywords; ++k)
+    {
+        names.push_back("Keyword" + std::to_string(k));
+    }
+
+    std::mt19937 rng(3);
+    for (UInt32 formID = 1; formID <= numForms; ++formID)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            // Half the tags from the first 16 keywords, so queries hit
+            const std::string& name = names[rng() % 2 ? rng() % 16 : rng() % numKeywords];
+            mgr->AddKeyword(formID, name);
+            legacy.AddKeyword(formID, name);
+        }
+    }
+
+    const char* query[4] = { names[1].c_str(), names[5].c_str(), names[9].c_str(), names[1500].c_str() };
+    const int passes = s_quick ? 5 : 50;
+    const double calls = (double)numForms * passes;
+
+    auto legacyRun = [&](bool all) {
+        for (int p = 0; p < passes; ++p)
+        {
+            for (UInt32 formID = 1; formID <= numForms; ++formID)
+            {
+                bool result = all;
+                for (const char* keyword : query)
+                {
+                    if (legacy.HasKeyword(formID, keyword) != all)
+                    {
+                        result = !all;
+                        break;
+                    }
+                }
+                s_sink += result;
+            }
+        }
+    };
+
+    // As the script commands run: the mask is built from the strings on
+    // every call
+    auto maskRun = [&](bool all, bool buildEachCall) {
+        KeywordMask mask;
+        mgr->BuildKeywordMask(query, 4, mask);
+        for (int p = 0; p < passes; ++p)
+        {
+            for (UInt32 formID = 1; formID <= numForms; ++formID)
+            {
+                if (buildEachCall)
+                {
+                    mask.Clear();
+                    mgr->BuildKeywordMask(query, 4, mask);
+                }
+                s_sink += all ? mgr->HasAllKeywords(formID, mask) : mgr->HasAnyKeyword(formID, mask);
+            }
+        }
+    };
+
+    for (bool all : { false, true })
+    {
+        double oldMs = BestMs(3, [&] { legacyRun(all); });
+        double maskMs = BestMs(3, [&] { maskRun(all, false); });
+        double buildMs = BestMs(3, [&] { maskRun(all, true); });
+        std::printf("  %-5s std::set x4 %7.1f ns | mask %6.1f ns | mask built per call %6.1f ns  (per query)\n",
+            all ? "all" : "any", oldMs * 1e6 / calls, maskMs * 1e6 / calls, buildMs * 1e6 / calls);
+    }
+}
+
+// ============================================================
+//  Form table lookup latency
+// ============================================================
+
+static void BenchFormTable()
+{
+    Section("Form table lookup, FormMap vs std::map");
+
+    std::vector<UInt32> sizes = { 1000, 10000, 100000, 1000000 };
+    if (s_quick) sizes = { 1000, 10000 };
+    const UInt32 lookups = s_quick ? 100000 : 2000000;
+
+    for (UInt32 size : sizes)
+    {
+        // Refs spread over a few mods: mod index in the high byte
+        std::mt19937 rng(size);
+        std::vector<UInt32> formIDs;
+        FormMap<UInt32> flat;
+        std::map<UInt32, UInt32> tree;
+        while (formIDs.size() < size)
+        {
+            UInt32 formID = ((rng() % 6) << 24) | (rng() & 0xFFFFFF);
+            if (!formID || tree.count(formID)) continue;
+            formIDs.push_back(formID);
+            flat[formID] = formID;
+            tree[formID] = formID;
+        }
+
+        std::vector<UInt32> order(lookups);
+        for (UInt32& formID : order) formID = formIDs[rng() % size];
+
+        double flatMs = BestMs(3, [&] {
+            for (UInt32 formID : order) s_sink += *flat.Find(formID);
+        });
+        double treeMs = BestMs(3, [&] {
+            for (UInt32 formID : order) s_sink += tree.find(formID)->second;
+        });
+        std::printf("  %8u forms: FormMap %6.1f ns | std::map %6.1f ns  (per random lookup)\n",
+            size, flatMs * 1e6 / lookups, treeMs * 1e6 / lookups);
+    }
+}
+
+// ============================================================
+//  Expression vs HasKeyword chain
+// ============================================================
+
+static void BenchExpressions()
+{
+    Section("\"Weapon & (Blade | Axe) & !Broken\" vs a HasKeyword chain");
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+    Legacy::KeywordStore legacy;
+
+    const UInt32 numForms = s_quick ? 2000 : 20000;
+    const char* vocabulary[] = { "Weapon", "Blade", "Axe", "Broken", "Iron", "Steel", "Armor", "Heavy" };
+    std::mt19937 rng(8);
+    for (UInt32 formID = 1; formID <= numForms; ++formID)
+    {
+        for (const char* keyword : vocabulary)
+        {
+            if (rng() % 2)
+            {
+                mgr->AddKeyword(formID, keyword);
+                legacy.AddKeyword(formID, keyword);
+            }
+        }
+    }
+
+    const int passes = s_quick ? 5 : 50;
+    const double calls = (double)numForms * passes;
+    const char* text = "Weapon & (Blade | Axe) & !Broken";
+
+    double exprMs = BestMs(3, [&] {
+        for (int p = 0; p < passes; ++p)
+        {
+            for (UInt32 formID = 1; formID <= numForms; ++formID)
+            {
+                // Looked up by text on every call, as the command does
+                s_sink += mgr->HasKeywordExpr(formID, *KeywordExprCache::Get(text));
+            }
+        }
+    });
+    double chainMs = BestMs(3, [&] {
+        for (int p = 0; p < passes; ++p)
+        {
+            for (UInt32 formID = 1; formID <= numForms; ++formID)
+            {
+                s_sink += mgr->HasKeyword(formID, "Weapon")
+                    && (mgr->HasKeyword(formID, "Blade") || mgr->HasKeyword(formID, "Axe"))
+                    && !mgr->HasKeyword(formID, "Broken");
+            }
+        }
+    });
+    double legacyMs = BestMs(3, [&] {
+        for (int p = 0; p < passes; ++p)
+        {
+            for (UInt32 formID = 1; formID <= numForms; ++formID)
+            {
+                s_sink += legacy.HasKeyword(formID, "Weapon")
+                    && (legacy.HasKeyword(formID, "Blade") || legacy.HasKeyword(formID, "Axe"))
+                    && !legacy.HasKeyword(formID, "Broken");
+            }
+        }
+    });
+    std::printf("  expression %6.1f ns | HasKeyword chain %6.1f ns | std::set chain %6.1f ns  (per form)\n",
+        exprMs * 1e6 / calls, chainMs * 1e6 / calls, legacyMs * 1e6 / calls);
+}
+
+// ============================================================
+//  Co-save size, save and load
+// ============================================================
+
+static void BenchCoSave()
+{
+    const UInt32 numForms = s_quick ? 10000 : 100000;
+    char title[128];
+    std::snprintf(title, sizeof(title), "Co-save, %u forms x 1-8 keywords of 500", numForms);
+    Section(title);
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+    Legacy::KeywordStore legacy;
+
+    std::mt19937 rng(11);
+    for (UInt32 i = 0; i < numForms; ++i)
+    {
+        UInt32 formID = ((i % 4) << 24) | (0x800 + i * 3);
+        for (int k = 0, n = 1 + rng() % 8; k < n; ++k)
+        {
+            std::string keyword = "SavedKeyword" + std::to_string(rng() % 500);
+            mgr->AddKeyword(formID, keyword);
+            legacy.AddKeyword(formID, keyword);
+        }
+    }
+
+    MockSerialization packed, records;
+    double packedSaveMs = BestMs(3, [&] { packed.Clear(); mgr->Save(packed.Interface()); });
+    double recordsSaveMs = BestMs(3, [&] { records.Clear(); legacy.Save(records.Interface()); });
+
+    UInt64 packedLoadAllocs = 0, recordsLoadAllocs = 0, legacyLoadAllocs = 0;
+    double packedLoadMs = BestMs(3, [&] {
+        mgr->ClearAllKeywords();
+        packed.Rewind();
+        packedLoadAllocs = CountAllocations([&] { mgr->Load(packed.Interface()); });
+    });
+    double recordsLoadMs = BestMs(3, [&] {
+        mgr->ClearAllKeywords();
+        records.Rewind();
+        recordsLoadAllocs = CountAllocations([&] { mgr->Load(records.Interface()); });
+    });
+    double legacyLoadMs = BestMs(3, [&] {
+        records.Rewind();
+        legacyLoadAllocs = CountAllocations([&] { legacy.Load(records.Interface()); });
+    });
+
+    std::printf("  KWPK v3:         %9u bytes, %6zu records, save %7.1f ms, load %7.1f ms, %9llu allocations\n",
+        packed.Bytes(), packed.records.size(), packedSaveMs, packedLoadMs, (unsigned long long)packedLoadAllocs);
+    std::printf("  v1 records:      %9u bytes, %6zu records, save %7.1f ms (old)\n",
+        records.Bytes(), records.records.size(), recordsSaveMs);
+    std::printf("    v1, new loader %46s load %7.1f ms, %9llu allocations\n", "",
+        recordsLoadMs, (unsigned long long)recordsLoadAllocs);
+    std::printf("    v1, old loader %46s load %7.1f ms, %9llu allocations\n", "",
+        legacyLoadMs, (unsigned long long)legacyLoadAllocs);
+    mgr->ClearAllKeywords();
+}
+
+// ============================================================
+//  INI corpus
+// ============================================================
+
+// Writes numFiles files of about bytesPerFile each to the INI directory and
+// returns their paths.  Editor IDs repeat across files, as in real
+// distributor INIs.
+static std::vector<std::string> WriteINICorpus(UInt32 numFiles, UInt32 bytesPerFile, UInt32 seed)
+{
+    TestSDK::ResetINIDirectory();
+    std::mt19937 rng(seed);
+    std::vector<std::string> paths;
+    for (UInt32 f = 0; f < numFiles; ++f)
+    {
+        std::string text = "; generated distributor INI\n[Weapons]\n";
+        while (text.size() < bytesPerFile)
+        {
+            if (rng() % 20 == 0) text += "; comment line\n";
+            text += "WeapEditorID" + std::to_string(rng() % 20000) + "   = ";
+            for (int k = 0, n = 1 + rng() % 6; k < n; ++k)
+            {
+                text += (k ? ", Keyword" : "Keyword") + std::to_string(rng() % 400);
+            }
+            text += rng() % 10 == 0 ? " ; trailing comment\r\n" : "\r\n";
+        }
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "bench%03u.ini", f);
+        TestSDK::WriteINIFile(name, text);
+        paths.push_back(INILoader::GetINIDirectory() + name);
+    }
+    return paths;
+}
+
+// ============================================================
+//  Parse stage, parallel vs sequential
+// ============================================================
+
+static void BenchParseStage()
+{
+    const UInt32 numFiles = s_quick ? 40 : 250;
+    const UInt32 bytesPerFile = s_quick ? 20000 : 100000;
+    std::vector<std::string> paths = WriteINICorpus(numFiles, bytesPerFile, 16);
+
+    char title[128];
+    std::snprintf(title, sizeof(title), "Parse stage, %u files of %u KB", numFiles, bytesPerFile / 1000);
+    Section(title);
+
+    double sequentialMs = BestMs(3, [&] {
+        for (const std::string& path : paths) s_sink += INILoader::ParseFile(path).lines.size();
+    });
+    double parallelMs = BestMs(3, [&] {
+        for (const INIParsedFile& file : INILoader::ParseFiles(paths)) s_sink += file.lines.size();
+    });
+    std::printf("  sequential ParseFile %7.1f ms | ParseFiles %7.1f ms on %u hardware thread(s)\n",
+        sequentialMs, parallelMs, std::thread::hardware_concurrency());
+}
+
+// ============================================================
+//  Tokenizer throughput
+// ============================================================
+
+static void BenchTokenizer()
+{
+    const UInt32 numFiles = 50;
+    const UInt32 bytesPerFile = s_quick ? 40000 : 1000000;
+    std::vector<std::string> paths = WriteINICorpus(numFiles, bytesPerFile, 17);
+    const double megabytes = numFiles * (double)bytesPerFile / 1e6;
+
+    char title[128];
+    std::snprintf(title, sizeof(title), "Tokenizer throughput, %.0f MB in %u files, one thread",
+        megabytes, numFiles);
+    Section(title);
+
+    UInt64 newKeywords = 0, oldKeywords = 0;
+    double newMs = BestMs(3, [&] {
+        newKeywords = 0;
+        for (const std::string& path : paths) newKeywords += INILoader::ParseFile(path).keywords.size();
+    });
+    double oldMs = BestMs(3, [&] {
+        oldKeywords = 0;
+        for (const std::string& path : paths) oldKeywords += Legacy::ParseFile(path);
+    });
+    if (newKeywords != oldKeywords)
+    {
+        std::printf("  keyword counts differ: %llu vs %llu\n", (unsigned long long)newKeywords,
+            (unsigned long long)oldKeywords);
+        ++TestSDK::Failures();
+    }
+    std::printf("  ParseFile %7.1f MB/s | getline + ParseLine %7.1f MB/s\n",
+        megabytes / (newMs / 1000), megabytes / (oldMs / 1000));
+}
+
+// ============================================================
+//  LoadAll with and without INICache
+// ============================================================
+
+static void BenchLoadAll()
+{
+    const UInt32 numFiles = s_quick ? 10 : 40;
+    const UInt32 bytesPerFile = s_quick ? 20000 : 100000;
+    char title[128];
+    std::snprintf(title, sizeof(title), "LoadAll, %u files of %u KB", numFiles, bytesPerFile / 1000);
+    Section(title);
+
+    WriteINICorpus(numFiles, bytesPerFile, 18);
+    std::remove(INILoader::GetCachePath().c_str());
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+
+    auto loadAll = [mgr] {
+        TestSDK::ClearLog();
+        return BestMs(1, [mgr] { mgr->BuildBaseline([] { INILoader::LoadAll(); }); });
+    };
+
+    double coldMs = loadAll();
+    double tableMs = loadAll();
+    bool usedTable = TestSDK::LogContains("from the resolved cache");
+
+    // One edited file: the rest come from the parsed cache
+    TestSDK::WriteINIFile("bench000.ini", "WeapEditorID1 = Edited\n");
+    double oneChangedMs = loadAll();
+
+    std::printf("  no cache %7.1f ms | one file changed %7.1f ms | unchanged%s %7.1f ms\n",
+        coldMs, oneChangedMs, usedTable ? " (resolved table)" : "", tableMs);
+    mgr->ClearAllKeywords();
+}
+
+// ============================================================
+//  Per-call KeywordAPI vs batch
+// ============================================================
+
+void KeywordMessageHandler(OBSEMessagingInterface::Message* msg);
+
+static bool Dispatch(PluginHandle, UInt32 type, void* data, UInt32 dataLen, const char*)
+{
+    OBSEMessagingInterface::Message msg = { "OBSEKeywords", type, dataLen, data };
+    KeywordMessageHandler(&msg);
+    return true;
+}
+
+static void BenchBatch()
+{
+    Section("KeywordAPI, 1000 forms x 8 keywords");
+
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+
+    const char* keywords[8] = { "Weapon", "Armor", "Clothing", "Jewelry", "Enchanted", "Iron", "Steel", "Unique" };
+    std::vector<UInt32> formIDs;
+    std::mt19937 rng(22);
+    for (UInt32 i = 0; i < 1000; ++i)
+    {
+        UInt32 formID = 0x01000800 + i;
+        formIDs.push_back(formID);
+        for (const char* keyword : keywords)
+        {
+            if (rng() % 3 == 0) mgr->AddKeyword(formID, keyword);
+        }
+    }
+
+    static OBSEMessagingInterface messaging = {};
+    messaging.Dispatch = Dispatch;
+    KeywordAPI::Init(&messaging, 1);
+    KeywordAPI::s_ready = true;
+
+    std::vector<UInt64> masks(formIDs.size());
+    KeywordAPI::BatchData batch = { formIDs.data(), (UInt32)formIDs.size(), keywords, nullptr, 8,
+        nullptr, masks.data(), false };
+
+    auto perCall = [&] {
+        for (UInt32 formID : formIDs)
+        {
+            for (const char* keyword : keywords) s_sink += KeywordAPI::HasKeyword(formID, keyword);
+        }
+    };
+    auto batched = [&] {
+        KeywordAPI::HasKeywordsBatch(batch);
+        s_sink += masks[0];
+    };
+
+    const int reps = s_quick ? 3 : 20;
+    KeywordAPI::s_interface = nullptr;
+    double messageCallMs = BestMs(reps, perCall);
+    double messageBatchMs = BestMs(reps, batched);
+    KeywordAPI::GetInterface();
+    double interfaceCallMs = BestMs(reps, perCall);
+    double interfaceBatchMs = BestMs(reps, batched);
+
+    std::printf("  messages:  per-call HasKeyword %8.1f us | batch %7.1f us\n", messageCallMs * 1000, messageBatchMs * 1000);
+    std::printf("  interface: per-call HasKeyword %8.1f us | batch %7.1f us\n", interfaceCallMs * 1000, interfaceBatchMs * 1000);
+    KeywordAPI::s_interface = nullptr;
+    mgr->ClearAllKeywords();
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!std::strcmp(argv[i], "--quick")) s_quick = true;
+    }
+
+    BenchLookupAllocations();
+    BenchAnyAll();
+    BenchFormTable();
+    BenchExpressions();
+    BenchCoSave();
+    BenchParseStage();
+    BenchTokenizer();
+    BenchLoadAll();
+    BenchBatch();
+
+    TestSDK::ResetINIDirectory();
+    std::printf("\n(checksum %llu)\n", (unsigned long long)s_sink);
+    return TestSDK::Failures() ? 1 : 0;
+}
@@ -0,0 +1,262 @@
+// Keyword queries: expression parsing and its error messages, expression
+// evaluation and FindForms, the any / all paths (masks and the query
+// planner) against a brute-force check, with more keywords than the mask
+// holds inline, and script handles.
+
+#include "Keywords.h"
+#include "TestSDK.h"
+
+#include <random>
+#include <unordered_map>
+
+static std::string CompileError(const char* text)
+{
+    KeywordExpr expr;
+    std::string error;
+    if (expr.Compile(text, error)) return "";
+    return error;
+}
+
+static void TestParser()
+{
+    CHECK(CompileError("Weapon & (Blade | Axe) & !Broken").empty());
+    CHECK(CompileError("  Two Words | !!Other ").empty());
+
+    CHECK(CompileError("") == "expected a keyword at offset 0");
+    CHECK(CompileError("a &") == "expected a keyword at offset 3");
+    CHECK(CompileError("!") == "expected a keyword at offset 1");
+    CHECK(CompileError("a | | b") == "expected a keyword at offset 4");
+    CHECK(CompileError("a & (b") == "missing ')' at offset 6");
+    CHECK(CompileError("((a)") == "missing ')' at offset 4");
+    CHECK(CompileError("a)") == "unexpected ')' at offset 1");
+    CHECK(CompileError("a & b)") == "unexpected ')' at offset 5");
+    CHECK(CompileError("(a) b") == "unexpected token 'b' at offset 4");
+    CHECK(CompileError("a !b") == "unexpected token '!' at offset 2");
+    CHECK(CompileError("a (b)") == "unexpected token '(' at offset 2");
+    CHECK(CompileError("(a) Weapon Blade   ") == "unexpected token 'Weapon Blade' at offset 4");
+
+    // Chains of one operator are merged into a single node
+    KeywordExpr expr;
+    std::string error;
+    CHECK(expr.Compile("a & b & c & (d | e | f)", error));
+    CHECK(expr.GetNodes().size() == 8);
+    CHECK(expr.GetNodes()[0].op == KeywordExpr::kOp_And && expr.GetNodes()[0].arg == 4);
+    CHECK(expr.GetNodes()[0].size == 8);
+
+    CHECK(KeywordExprCache::Get("a & (b") == nullptr);
+    CHECK(KeywordExprCache::Get("a & b") == KeywordExprCache::Get("a & b"));
+}
+
+static void TestExpressions()
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+
+    mgr->AddKeyword(1, "Weapon");
+    mgr->AddKeyword(1, "Blade");
+    mgr->AddKeyword(2, "Weapon");
+    mgr->AddKeyword(2, "Axe");
+    mgr->AddKeyword(2, "Broken");
+    mgr->AddKeyword(3, "Armor");
+
+    auto evaluate = [mgr](const char* text, UInt32 formID) {
+        const KeywordExpr* expr = KeywordExprCache::Get(text);
+        return expr && mgr->HasKeywordExpr(formID, *expr);
+    };
+
+    const char* weapon = "WEAPON & (Blade | Axe) & !Broken";
+    CHECK(evaluate(weapon, 1) && !evaluate(weapon, 2) && !evaluate(weapon, 3));
+    CHECK(evaluate("armor | blade", 3));
+    CHECK(evaluate("!!Armor", 3) && !evaluate("!(armor)", 3));
+    CHECK(evaluate("Unknown1 & Unknown2 | Weapon", 1));
+    CHECK(evaluate("!Weapon", 4));
+
+    // Unknown keywords match nothing and are not interned
+    UInt32 numInterned = mgr->GetNumKeywordIDs();
+    CHECK(!evaluate("NeverInterned", 1) && evaluate("!NeverInterned", 1));
+    CHECK(evaluate("Weapon & !(NeverInterned | Broken)", 1));
+    CHECK(mgr->GetNumKeywordIDs() == numInterned);
+
+    // A cached expression sees a keyword interned after it was compiled
+    CHECK(!evaluate("AddedLater", 1) && evaluate("!AddedLater", 1));
+    mgr->AddKeyword(1, "AddedLater");
+    CHECK(evaluate("AddedLater", 1) && !evaluate("!AddedLater", 1));
+
+    // FindForms against evaluating every form
+    std::mt19937 rng(5);
+    const char* vocabulary[] = { "Q0", "Q1", "Q2", "Q3", "Q4", "Q5" };
+    for (UInt32 formID = 10; formID < 3000; ++formID)
+    {
+        for (const char* keyword : vocabulary)
+        {
+            if (rng() % 3 == 0) mgr->AddKeyword(formID, keyword);
+        }
+    }
+
+    const char* queries[] = { "Q0", "Q0 & Q1", "Q1 | !Q2", "!Q3 & !Q4", "Q5 & !Q5", "(Q0 | Q1) & (Q2 | Q3) & !Q4",
+        "Never", "!Never & Q2" };
+    for (const char* text : queries)
+    {
+        const KeywordExpr* expr = KeywordExprCache::Get(text);
+        CHECK(expr != nullptr);
+        if (!expr) continue;
+
+        std::vector<UInt32> found;
+        CHECK(mgr->FindForms(*expr, found));
+
+        std::vector<UInt32> expected;
+        for (UInt32 formID = 1; formID < 3000; ++formID)
+        {
+            if (mgr->GetKeywordCount(formID) && mgr->HasKeywordExpr(formID, *expr)) expected.push_back(formID);
+        }
+        CHECK(found == expected);
+    }
+}
+
+static void TestAnyAll()
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+
+    // A vocabulary past the mask's inline 1024 IDs, with a few common
+    // keywords and many rare ones
+    const UInt32 numKeywords = 1500;
+    std::vector<UInt32> keywordIDs;
+    for (UInt32 k = 0; k < numKeywords; ++k)
+    {
+        keywordIDs.push_back(mgr->InternKeyword("Vocab" + std::to_string(k)));
+    }
+
+    std::mt19937 rng(17);
+    const UInt32 numForms = 4000;
+    for (UInt32 formID = 1; formID <= numForms; ++formID)
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            if (rng() % 2) mgr->AddKeywordID(formID, keywordIDs[k]);
+        }
+        for (int k = 0, n = rng() % 12; k < n; ++k)
+        {
+            mgr->AddKeywordID(formID, keywordIDs[rng() % numKeywords]);
+        }
+    }
+
+    for (int iter = 0; iter < 20000; ++iter)
+    {
+        UInt32 formID = rng() % (numForms + 100) + 1;
+
+        UInt32 ids[KeywordCheck::kMaxKeywords];
+        UInt32 count = 1 + rng() % KeywordCheck::kMaxKeywords;
+        for (UInt32 i = 0; i < count; ++i)
+        {
+            UInt32 pick = rng() % 10;
+            ids[i] = pick == 0 ? kInvalidKeywordID
+                : pick < 5 ? keywordIDs[rng() % 4]
+                : keywordIDs[rng() % numKeywords];
+        }
+
+        bool any = false, all = true;
+        for (UInt32 i = 0; i < count; ++i)
+        {
+            if (ids[i] == kInvalidKeywordID) continue;
+            bool has = mgr->HasKeywordID(formID, ids[i]);
+            any = any || has;
+            all = all && has;
+        }
+
+        KeywordMask mask;
+        mgr->BuildKeywordMask(ids, count, mask);
+        CHECK(mgr->HasAnyKeyword(formID, mask) == any);
+        CHECK(mgr->HasAllKeywords(formID, mask) == all);
+
+        KeywordCheck anyCheck, allCheck;
+        mgr->PlanKeywordCheck(ids, count, false, anyCheck);
+        mgr->PlanKeywordCheck(ids, count, true, allCheck);
+        CHECK(mgr->HasKeywords(formID, anyCheck) == any);
+        CHECK(mgr->HasKeywords(formID, allCheck) == all);
+
+        UInt8 results[KeywordCheck::kMaxKeywords];
+        mgr->HasKeywordIDs(formID, ids, count, results);
+        for (UInt32 i = 0; i < count; ++i)
+        {
+            CHECK(results[i] == (ids[i] != kInvalidKeywordID && mgr->HasKeywordID(formID, ids[i])));
+        }
+    }
+
+    // Unknown keywords are reported, not interned
+    const char* names[] = { "Vocab1", "NotAKeyword", nullptr, "" };
+    UInt32 found[4];
+    UInt32 numInterned = mgr->GetNumKeywordIDs();
+    CHECK(mgr->FindKeywordIDs(names, 4, found) == 1);
+    CHECK(found[0] == keywordIDs[1] && found[1] == kInvalidKeywordID && found[2] == kInvalidKeywordID);
+    CHECK(mgr->GetNumKeywordIDs() == numInterned);
+
+    KeywordMask mask;
+    CHECK(mgr->BuildKeywordMask(names, 4, mask) == 1);
+    CHECK(mask.Test(keywordIDs[1]));
+
+    KeywordCheck check;
+    UInt32 outOfRange[] = { keywordIDs[0], 0x7FFFFFFF };
+    CHECK(mgr->PlanKeywordCheck(outOfRange, 2, true, check) == 1 && check.count == 1);
+
+    // The INI index with an ID where keywordID + 1 wraps, empty and built
+    FrozenKeywordIndex index;
+    UInt32 count = 1;
+    CHECK(index.GetForms(0xFFFFFFFF, count) == nullptr && count == 0);
+    FormMap<KeywordSet> formKeywords;
+    formKeywords[1].Insert(keywordIDs[0]);
+    index.Build(formKeywords, mgr->GetNumKeywordIDs());
+    CHECK(index.GetForms(0xFFFFFFFF, count) == nullptr && count == 0);
+    CHECK(index.GetForms(keywordIDs[0], count) != nullptr && count == 1);
+}
+
+static void TestScriptHandles()
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+
+    // Derived from the name alone, so a handle kept in a save means the same
+    // keyword whatever order this session interns keywords in
+    UInt32 handle = KeywordManager::ScriptHandleOf("handlekeyword");
+    CHECK(handle != 0 && handle < 0x80000000);
+    CHECK(mgr->ResolveScriptHandle(handle) == kInvalidKeywordID);
+    UInt32 keywordID = mgr->InternKeyword("HandleKeyword");
+    CHECK(mgr->GetScriptHandle(keywordID) == handle);
+    CHECK(mgr->ResolveScriptHandle(handle) == keywordID);
+    CHECK(mgr->GetScriptHandle(kInvalidKeywordID) == 0);
+
+    // Two names that give the same handle: it resolves to neither
+    std::unordered_map<UInt32, std::string> seen;
+    std::string first, second;
+    for (UInt32 i = 0; second.empty(); ++i)
+    {
+        std::string name = "clash" + std::to_string(i);
+        auto inserted = seen.emplace(KeywordManager::ScriptHandleOf(name), name);
+        if (!inserted.second)
+        {
+            first = inserted.first->second;
+            second = name;
+        }
+    }
+    UInt32 firstID = mgr->InternKeyword(first);
+    UInt32 shared = mgr->GetScriptHandle(firstID);
+    CHECK(shared != 0);
+    UInt32 secondID = mgr->InternKeyword(second);
+    CHECK(mgr->GetScriptHandle(firstID) == 0 && mgr->GetScriptHandle(secondID) == 0);
+    CHECK(mgr->ResolveScriptHandle(shared) == kInvalidKeywordID);
+}
+
+int main()
+{
+    TestParser();
+    TestExpressions();
+    TestAnyAll();
+    TestScriptHandles();
+
+    if (TestSDK::Failures())
+    {
+        std::fprintf(stderr, "query_test: %d check(s) failed\n", TestSDK::Failures());
+        return 1;
+    }
+    std::printf("query_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "obse/PluginAPI.h"
+#include <string>
+
+// Editor IDs resolve to TestSDK::EditorFormID(editorID), except those
+// starting with "Missing", which never resolve
+namespace EditorIDMapper
+{
+    void MessageHandler(OBSEMessagingInterface::Message* msg);
+    void Init(OBSEMessagingInterface* msgIntfc, PluginHandle pluginHandle);
+    bool IsReady();
+    UInt32 Lookup(const std::string& editorID);
+}
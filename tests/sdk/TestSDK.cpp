@@ -0,0 +1,298 @@
+#include "TestSDK.h"
+#include "obse/CommandTable.h"
+#include "obse/GameAPI.h"
+#include "obse/GameData.h"
+#include "obse/GameForms.h"
+#include "obse/StringVar.h"
+#include "EditorIDMapper/EditorIDMapperAPI.h"
+#include "INIParser.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    std::string              s_log;
+    bool                     s_echo = false;
+    bool                     s_mapperReady = true;
+    UInt32                   s_mapperLookups = 0;
+    std::vector<std::string> s_modNames = { "Oblivion.esm" };
+    DataHandler              s_dataHandler;
+    DataHandler*             s_dataHandlerPtr = &s_dataHandler;
+
+    void AppendLog(const char* prefix, const char* fmt, va_list args)
+    {
+        char buffer[1024];
+        vsnprintf(buffer, sizeof(buffer), fmt, args);
+        s_log += prefix;
+        s_log += buffer;
+        s_log += '\n';
+        if (s_echo) std::fprintf(stderr, "%s%s\n", prefix, buffer);
+    }
+}
+
+// ===== Logging =====
+
+void _MESSAGE(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    AppendLog("", fmt, args);
+    va_end(args);
+}
+
+void _WARNING(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    AppendLog("warning: ", fmt, args);
+    va_end(args);
+}
+
+void _ERROR(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    AppendLog("error: ", fmt, args);
+    va_end(args);
+}
+
+// ===== Game =====
+
+bool ExtractArgs(ParamInfo*, void*, UInt32*, TESObjectREFR*, UInt32, Script*, ScriptEventList*, ...)
+{
+    return false;
+}
+
+void Console_Print(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    AppendLog("console: ", fmt, args);
+    va_end(args);
+}
+
+TESForm* LookupFormByID(UInt32)
+{
+    return nullptr;
+}
+
+bool AssignToStringVar(ParamInfo*, void*, TESObjectREFR*, UInt32, Script*, ScriptEventList*, double*, UInt32*,
+    const char*)
+{
+    return true;
+}
+
+TESForm::~TESForm() {}
+
+OBSEArrayVarInterface::Element::Element() {}
+OBSEArrayVarInterface::Element::Element(double) {}
+OBSEArrayVarInterface::Element::Element(TESForm*) {}
+OBSEArrayVarInterface::Element::Element(const char*) {}
+OBSEArrayVarInterface::Element::Element(Array*) {}
+
+OBSEScriptInterface* g_scriptInterface = nullptr;
+DataHandler** g_dataHandler = &s_dataHandlerPtr;
+
+UInt8 DataHandler::GetModIndex(const char* modName)
+{
+    for (UInt32 i = 0; i < s_modNames.size(); ++i)
+    {
+        if (!_stricmp(s_modNames[i].c_str(), modName)) return i;
+    }
+    return 0xFF;
+}
+
+UInt8 DataHandler::GetActiveModCount() const
+{
+    return s_modNames.size();
+}
+
+const char* DataHandler::GetNthModName(UInt32 modIndex)
+{
+    return modIndex < s_modNames.size() ? s_modNames[modIndex].c_str() : nullptr;
+}
+
+// ===== EditorIDMapper =====
+
+namespace EditorIDMapper
+{
+    void MessageHandler(OBSEMessagingInterface::Message*) {}
+    void Init(OBSEMessagingInterface*, PluginHandle) {}
+
+    bool IsReady()
+    {
+        return s_mapperReady;
+    }
+
+    UInt32 Lookup(const std::string& editorID)
+    {
+        if (!s_mapperReady) return 0;
+
+        ++s_mapperLookups;
+        return editorID.rfind("Missing", 0) == 0 ? 0 : TestSDK::EditorFormID(editorID);
+    }
+}
+
+// ===== Windows =====
+
+#ifndef _WIN32
+#include <Windows.h>
+#include <sys/stat.h>
+
+namespace
+{
+    // Without Windows the INI directory's backslashes are part of the
+    // file names, so its files sit in the working directory named
+    // "Data\OBSE\Plugins\OBSEKeywords\<file>"
+    struct FindState
+    {
+        std::vector<std::string> names;
+        std::size_t              next = 0;
+    };
+
+    void FillFindData(const std::string& name, WIN32_FIND_DATAA* findData)
+    {
+        struct stat info = {};
+        stat(name.c_str(), &info);
+
+        std::memset(findData, 0, sizeof(*findData));
+        std::string fileName = name.substr(name.rfind('\\') + 1);
+        std::strncpy(findData->cFileName, fileName.c_str(), MAX_PATH - 1);
+        findData->nFileSizeLow = static_cast<DWORD>(info.st_size);
+        findData->nFileSizeHigh = static_cast<DWORD>(static_cast<UInt64>(info.st_size) >> 32);
+
+        UInt64 writeTime = info.st_mtim.tv_sec * 10000000ull + info.st_mtim.tv_nsec / 100;
+        findData->ftLastWriteTime.dwLowDateTime = static_cast<DWORD>(writeTime);
+        findData->ftLastWriteTime.dwHighDateTime = static_cast<DWORD>(writeTime >> 32);
+    }
+}
+
+HANDLE FindFirstFileA(const char* pattern, WIN32_FIND_DATAA* findData)
+{
+    // Only "<dir>*.ini" patterns are used
+    std::string dir(pattern);
+    dir.resize(dir.rfind('\\') + 1);
+
+    FindState* state = new FindState;
+    for (const auto& entry : std::filesystem::directory_iterator("."))
+    {
+        std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.rfind(dir, 0) == 0 && name.size() > dir.size() + 4
+            && name.compare(name.size() - 4, 4, ".ini") == 0)
+        {
+            state->names.push_back(name);
+        }
+    }
+    std::sort(state->names.begin(), state->names.end());
+
+    if (state->names.empty())
+    {
+        delete state;
+        return INVALID_HANDLE_VALUE;
+    }
+    FillFindData(state->names[state->next++], findData);
+    return state;
+}
+
+BOOL FindNextFileA(HANDLE find, WIN32_FIND_DATAA* findData)
+{
+    FindState* state = static_cast<FindState*>(find);
+    if (state->next >= state->names.size()) return 0;
+
+    FillFindData(state->names[state->next++], findData);
+    return 1;
+}
+
+BOOL FindClose(HANDLE find)
+{
+    delete static_cast<FindState*>(find);
+    return 1;
+}
+#endif
+
+// ===== Test hooks =====
+
+namespace TestSDK
+{
+    const std::string& Log()
+    {
+        return s_log;
+    }
+
+    void ClearLog()
+    {
+        s_log.clear();
+    }
+
+    bool LogContains(const char* text)
+    {
+        return s_log.find(text) != std::string::npos;
+    }
+
+    void SetEcho(bool echo)
+    {
+        s_echo = echo;
+    }
+
+    void SetMapperReady(bool ready)
+    {
+        s_mapperReady = ready;
+    }
+
+    UInt32 MapperLookups()
+    {
+        return s_mapperLookups;
+    }
+
+    UInt32 EditorFormID(const std::string& editorID)
+    {
+        // FNV-1a, kept in the range of a plugin-added form
+        UInt32 hash = 2166136261u;
+        for (char c : editorID)
+        {
+            hash = (hash ^ static_cast<UInt8>(c)) * 16777619u;
+        }
+        return (hash & 0x00FFFFFF) | 0x01000000;
+    }
+
+    void SetModList(const std::vector<std::string>& modNames)
+    {
+        s_modNames = modNames;
+    }
+
+    void ResetINIDirectory()
+    {
+        std::string dir = INILoader::GetINIDirectory();
+#ifdef _WIN32
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+#else
+        for (const auto& entry : std::filesystem::directory_iterator("."))
+        {
+            if (entry.path().filename().string().rfind(dir, 0) == 0)
+            {
+                std::filesystem::remove(entry.path());
+            }
+        }
+#endif
+    }
+
+    void WriteINIFile(const std::string& name, const std::string& text)
+    {
+        std::ofstream(INILoader::GetINIDirectory() + name, std::ios::binary) << text;
+    }
+
+    void DeleteINIFile(const std::string& name)
+    {
+        std::filesystem::remove(INILoader::GetINIDirectory() + name);
+    }
+
+    int& Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// ============================================================
+//  Test hooks into the SDK stand-in, plus a minimal CHECK for
+//  the test programs
+// ============================================================
+
+namespace TestSDK
+{
+    // Everything passed to _MESSAGE, _WARNING and _ERROR since the last
+    // ClearLog, one line per call
+    const std::string& Log();
+    void ClearLog();
+    bool LogContains(const char* text);
+
+    // Echo log lines to stderr as well (off by default)
+    void SetEcho(bool echo);
+
+    // EditorIDMapper: ready or not, and how many lookups it has answered
+    void SetMapperReady(bool ready);
+    UInt32 MapperLookups();
+
+    // The form ID EditorIDMapper::Lookup returns for editorID
+    UInt32 EditorFormID(const std::string& editorID);
+
+    // Active mods, in load order (index = mod index)
+    void SetModList(const std::vector<std::string>& modNames);
+
+    // Removes every file from the INI directory and makes sure it exists
+    void ResetINIDirectory();
+
+    // Writes text to name in the INI directory
+    void WriteINIFile(const std::string& name, const std::string& text);
+    void DeleteINIFile(const std::string& name);
+
+    // Failed CHECKs so far
+    int& Failures();
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            ++TestSDK::Failures(); \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "obse/PluginAPI.h"
+
+// Commands take all of these whether they use them or not
+#define COMMAND_ARGS [[maybe_unused]] ParamInfo* paramInfo, [[maybe_unused]] void* arg1, [[maybe_unused]] TESObjectREFR* thisObj, [[maybe_unused]] UInt32 arg3, [[maybe_unused]] Script* scriptObj, [[maybe_unused]] ScriptEventList* eventList, double* result, [[maybe_unused]] UInt32* opcodeOffsetPtr
+#define PASS_COMMAND_ARGS paramInfo, arg1, thisObj, arg3, scriptObj, eventList, result, opcodeOffsetPtr
+#define EXTRACT_ARGS paramInfo, arg1, opcodeOffsetPtr, thisObj, arg3, scriptObj, eventList
+#define PASS_EXTRACT_ARGS paramInfo, arg1, opcodeOffsetPtr, thisObj, arg3, scriptObj, eventList
+
+typedef bool (*Cmd_Execute)(COMMAND_ARGS);
+
+struct CommandInfo
+{
+    const char* longName;
+    const char* shortName;
+    UInt32      opcode;
+    const char* helpText;
+    UInt16      needsParent;
+    UInt16      numParams;
+    ParamInfo*  params;
+    Cmd_Execute execute;
+    void*       parse;
+    void*       eval;
+    UInt32      flags;
+};
+
+#define DEFINE_COMMAND_PLUGIN(name, description, refRequired, numParams, paramInfo) \
+    extern bool Cmd_ ## name ## _Execute(COMMAND_ARGS); \
+    CommandInfo kCommandInfo_ ## name = { #name, "", 0, description, refRequired, numParams, paramInfo, Cmd_ ## name ## _Execute, 0, 0, 0 };
+
+// Script commands are not run by the tests; this always fails
+bool ExtractArgs(ParamInfo* paramInfo, void* arg1, UInt32* opcodeOffsetPtr, TESObjectREFR* thisObj,
+    UInt32 arg3, Script* scriptObj, ScriptEventList* eventList, ...);
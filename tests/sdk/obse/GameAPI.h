@@ -0,0 +1,6 @@
+#pragma once
+
+struct TESForm;
+
+void Console_Print(const char* fmt, ...);
+TESForm* LookupFormByID(UInt32 refID);
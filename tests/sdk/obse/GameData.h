@@ -0,0 +1,12 @@
+#pragma once
+
+// The active mods are set with TestSDK::SetModList
+class DataHandler
+{
+public:
+    UInt8 GetModIndex(const char* modName);
+    UInt8 GetActiveModCount() const;
+    const char* GetNthModName(UInt32 modIndex);
+};
+
+extern DataHandler** g_dataHandler;
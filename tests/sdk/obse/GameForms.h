@@ -0,0 +1,15 @@
+#pragma once
+
+struct TESForm
+{
+    virtual ~TESForm();
+
+    UInt8  typeID;
+    UInt32 flags;
+    UInt32 refID;
+};
+
+struct TESObjectREFR : TESForm
+{
+    TESForm* baseForm;
+};
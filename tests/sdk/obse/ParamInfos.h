@@ -0,0 +1,16 @@
+#pragma once
+
+struct ParamInfo
+{
+    const char* typeStr;
+    UInt32      typeID;
+    UInt32      isOptional;
+};
+
+enum
+{
+    kParamType_String = 0x00,
+    kParamType_Integer = 0x01,
+    kParamType_ObjectRef = 0x04,
+    kParamType_TESObject = 0x3B,
+};
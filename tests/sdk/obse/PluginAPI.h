@@ -0,0 +1,150 @@
+#pragma once
+
+struct TESForm;
+struct TESObjectREFR;
+struct Script;
+struct ScriptEventList;
+struct ParamInfo;
+struct CommandInfo;
+
+typedef UInt32 PluginHandle;
+
+enum
+{
+    kPluginHandle_Invalid = 0xFFFFFFFF,
+};
+
+enum
+{
+    kInterface_Serialization = 0,
+    kInterface_Console,
+    kInterface_Messaging,
+    kInterface_CommandTable,
+    kInterface_StringVar,
+    kInterface_ArrayVar,
+    kInterface_Script,
+};
+
+enum CommandReturnType
+{
+    kRetnType_Default,
+    kRetnType_Form,
+    kRetnType_String,
+    kRetnType_Array,
+};
+
+#define OBSE_VERSION_INTEGER 21
+
+struct PluginInfo
+{
+    enum { kInfoVersion = 3 };
+
+    UInt32      infoVersion;
+    const char* name;
+    UInt32      version;
+};
+
+struct OBSEInterface
+{
+    UInt32 obseVersion;
+    UInt32 oblivionVersion;
+    UInt32 editorVersion;
+    UInt32 isEditor;
+    bool   (*RegisterCommand)(CommandInfo* info);
+    void   (*SetOpcodeBase)(UInt32 opcode);
+    void*  (*QueryInterface)(UInt32 id);
+    PluginHandle (*GetPluginHandle)(void);
+    bool   (*RegisterTypedCommand)(CommandInfo* info, CommandReturnType retnType);
+};
+
+struct OBSESerializationInterface
+{
+    enum { kVersion = 2 };
+
+    typedef void (*EventCallback)(void* reserved);
+
+    UInt32 version;
+    void   (*SetUniqueID)(PluginHandle plugin, UInt32 uid);
+    void   (*SetRevertCallback)(PluginHandle plugin, EventCallback callback);
+    void   (*SetSaveCallback)(PluginHandle plugin, EventCallback callback);
+    void   (*SetLoadCallback)(PluginHandle plugin, EventCallback callback);
+    void   (*SetNewGameCallback)(PluginHandle plugin, EventCallback callback);
+    bool   (*WriteRecord)(UInt32 type, UInt32 version, const void* buf, UInt32 length);
+    bool   (*OpenRecord)(UInt32 type, UInt32 version);
+    bool   (*WriteRecordData)(const void* buf, UInt32 length);
+    bool   (*GetNextRecordInfo)(UInt32* type, UInt32* version, UInt32* length);
+    UInt32 (*ReadRecordData)(void* buf, UInt32 length);
+    bool   (*ResolveRefID)(UInt32 refID, UInt32* outRefID);
+    void   (*SetPreloadCallback)(PluginHandle plugin, EventCallback callback);
+};
+
+struct OBSEMessagingInterface
+{
+    struct Message
+    {
+        const char* sender;
+        UInt32      type;
+        UInt32      dataLen;
+        void*       data;
+    };
+
+    typedef void (*EventCallback)(Message* msg);
+
+    enum { kVersion = 1 };
+
+    enum
+    {
+        kMessage_PostLoad,
+        kMessage_ExitGame,
+        kMessage_ExitToMainMenu,
+        kMessage_LoadGame,
+        kMessage_SaveGame,
+        kMessage_Precompile,
+        kMessage_PreLoadGame,
+        kMessage_ExitGame_Console,
+        kMessage_PostLoadGame,
+        kMessage_PostPostLoad,
+        kMessage_RuntimeScriptError,
+        kMessage_DeleteGame,
+        kMessage_RenameGame,
+        kMessage_RenameNewGame,
+        kMessage_NewGame,
+        kMessage_DeleteGameName,
+        kMessage_RenameGameName,
+        kMessage_RenameNewGameName,
+        kMessage_GameInitialized,
+    };
+
+    UInt32 version;
+    bool   (*RegisterListener)(PluginHandle listener, const char* sender, EventCallback handler);
+    bool   (*Dispatch)(PluginHandle sender, UInt32 messageType, void* data, UInt32 dataLen, const char* receiver);
+};
+
+struct OBSEArrayVarInterface
+{
+    enum { kVersion = 1 };
+
+    struct Array;
+
+    struct Element
+    {
+        Element();
+        Element(double num);
+        Element(TESForm* form);
+        Element(const char* str);
+        Element(Array* array);
+    };
+
+    Array* (*CreateArray)(const Element* data, UInt32 size, Script* callingScript);
+    Array* (*CreateStringMap)(const char** keys, const Element* values, UInt32 size, Script* callingScript);
+    Array* (*CreateMap)(const double* keys, const Element* values, UInt32 size, Script* callingScript);
+    bool   (*AssignCommandResult)(Array* arr, double* dest);
+    void   (*SetElement)(Array* arr, const Element& key, const Element& value);
+    void   (*AppendElement)(Array* arr, const Element& value);
+};
+
+struct OBSEScriptInterface
+{
+    bool (*ExtractArgsEx)(...);
+    bool (*ExtractFormatStringArgs)(...);
+};
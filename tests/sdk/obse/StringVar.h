@@ -0,0 +1,6 @@
+#pragma once
+
+#include "obse/CommandTable.h"
+
+bool AssignToStringVar(ParamInfo* paramInfo, void* arg1, TESObjectREFR* thisObj, UInt32 arg3, Script* scriptObj,
+    ScriptEventList* eventList, double* result, UInt32* opcodeOffsetPtr, const char* newValue);
@@ -0,0 +1,52 @@
+#pragma once
+
+// ============================================================
+//  Stand-in for the OBSE SDK, just enough to build the plugin
+//  sources outside the game for tests/.  Only the declarations
+//  the plugin uses are here; TestSDK.cpp implements them.
+// ============================================================
+
+// The real prefix header pulls in the common CRT headers, which hash.hpp
+// relies on
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+typedef uint8_t  UInt8;
+typedef uint16_t UInt16;
+typedef uint32_t UInt32;
+typedef uint64_t UInt64;
+typedef int8_t   SInt8;
+typedef int16_t  SInt16;
+typedef int32_t  SInt32;
+typedef int64_t  SInt64;
+
+// Logged to TestSDK::Log() instead of a file
+void _MESSAGE(const char* fmt, ...);
+void _WARNING(const char* fmt, ...);
+void _ERROR(const char* fmt, ...);
+
+class IDebugLog
+{
+public:
+    IDebugLog(const char*) {}
+};
+
+#ifndef _WIN32
+#include <strings.h>
+
+#define _TRUNCATE ((size_t)-1)
+
+inline int strncpy_s(char* dest, size_t destSize, const char* src, size_t)
+{
+    strncpy(dest, src, destSize - 1);
+    dest[destSize - 1] = 0;
+    return 0;
+}
+
+inline int _stricmp(const char* a, const char* b)
+{
+    return strcasecmp(a, b);
+}
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+// The part of Windows.h the plugin uses, for building tests/ elsewhere.
+// FindFirstFileA lists a real directory; TestSDK.cpp implements it.
+
+#include <cstdint>
+
+typedef int           BOOL;
+typedef unsigned long DWORD;
+typedef void*         HANDLE;
+
+#define MAX_PATH 260
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define FILE_ATTRIBUTE_DIRECTORY 0x10
+
+struct FILETIME
+{
+    DWORD dwLowDateTime;
+    DWORD dwHighDateTime;
+};
+
+struct WIN32_FIND_DATAA
+{
+    DWORD    dwFileAttributes;
+    FILETIME ftCreationTime;
+    FILETIME ftLastAccessTime;
+    FILETIME ftLastWriteTime;
+    DWORD    nFileSizeHigh;
+    DWORD    nFileSizeLow;
+    DWORD    dwReserved0;
+    DWORD    dwReserved1;
+    char     cFileName[MAX_PATH];
+    char     cAlternateFileName[14];
+};
+
+HANDLE FindFirstFileA(const char* pattern, WIN32_FIND_DATAA* findData);
+BOOL FindNextFileA(HANDLE find, WIN32_FIND_DATAA* findData);
+BOOL FindClose(HANDLE find);
@@ -0,0 +1,239 @@
+// Co-save round trips through MockSerialization: version 3 delta writes and
+// reads, and reads of the version 2 (full KWPK) and version 1 (per keyword
+// records) formats older saves hold.
+
+#include "Keywords.h"
+#include "ByteStream.h"
+#include "Legacy.h"
+#include "MockSerialization.h"
+#include "TestSDK.h"
+
+#include <map>
+#include <set>
+
+typedef std::map<UInt32, std::set<std::string>> Snapshot;
+
+// Every form in [1, lastFormID] with keywords, names folded to lower case
+static Snapshot TakeSnapshot(KeywordManager* mgr, UInt32 lastFormID)
+{
+    Snapshot snapshot;
+    for (UInt32 formID = 1; formID <= lastFormID; ++formID)
+    {
+        for (std::string keyword : mgr->GetKeywords(formID))
+        {
+            for (char& c : keyword) c = FoldKeywordChar(c);
+            snapshot[formID].insert(keyword);
+        }
+    }
+    return snapshot;
+}
+
+static void LoadINILayer(KeywordManager* mgr)
+{
+    mgr->BuildBaseline([mgr] {
+        for (UInt32 formID = 1; formID <= 200; ++formID)
+        {
+            mgr->AddKeyword(formID, "Ini" + std::to_string(formID % 7), kSource_INI);
+            if (formID % 3 == 0) mgr->AddKeyword(formID, "Metal", kSource_INI);
+        }
+    });
+}
+
+static void TestDeltaRoundTrip()
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+    LoadINILayer(mgr);
+
+    mgr->AddKeyword(3, "Enchanted");        // added on top of the INI keywords
+    mgr->RemoveKeyword(6, "Metal");         // INI keyword removed
+    mgr->AddKeyword(500, "RuntimeOnly");    // form without INI keywords
+    mgr->AddKeyword(500, "Second");
+    mgr->ClearFormKeywords(9);              // every INI keyword removed
+    mgr->AddKeyword(12, "Temporary");       // edited back to the INI state
+    mgr->RemoveKeyword(12, "Temporary");
+    mgr->RemoveKeyword(15, "Metal");
+    mgr->AddKeyword(15, "Metal");
+
+    Snapshot expected = TakeSnapshot(mgr, 600);
+
+    MockSerialization save;
+    mgr->Save(save.Interface());
+    CHECK(save.records.size() == 1);
+    CHECK(save.records[0].type == 'KWPK');
+    CHECK(save.records[0].version == 3);
+
+    // Only the four forms that differ from the INI layer are written
+    CHECK(mgr->GetMemoryStats().numRuntimeForms == 4);
+    CHECK(TestSDK::LogContains("Saved runtime keyword changes for 4 forms"));
+
+    mgr->ClearRuntimeKeywords();
+    CHECK(!mgr->HasKeyword(3, "Enchanted"));
+    save.Rewind();
+    mgr->Load(save.Interface());
+    CHECK(TakeSnapshot(mgr, 600) == expected);
+    CHECK(mgr->GetKeywordCount(9) == 0);
+
+    // Saving the loaded state again gives the same record
+    MockSerialization again;
+    mgr->Save(again.Interface());
+    CHECK(again.records.size() == 1 && again.records[0].data == save.records[0].data);
+
+    // The deltas apply to whatever INI layer is loaded, so a form keeps its
+    // removal when the INI files change
+    mgr->ClearRuntimeKeywords();
+    mgr->BuildBaseline([mgr] {
+        mgr->AddKeyword(6, "Metal", kSource_INI);
+        mgr->AddKeyword(6, "Steel", kSource_INI);
+    });
+    save.Rewind();
+    mgr->Load(save.Interface());
+    CHECK(!mgr->HasKeyword(6, "Metal") && mgr->HasKeyword(6, "Steel"));
+    CHECK(mgr->HasKeyword(3, "Enchanted") && mgr->GetKeywordCount(3) == 1);
+
+    // An empty runtime layer still writes an (empty) record
+    mgr->ClearAllKeywords();
+    MockSerialization empty;
+    mgr->Save(empty.Interface());
+    CHECK(empty.records.size() == 1);
+    empty.Rewind();
+    mgr->Load(empty.Interface());
+    CHECK(TakeSnapshot(mgr, 600).empty());
+}
+
+static void TestFullRecordRead()
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+    LoadINILayer(mgr);
+
+    // Version 2: keyword table, form count, then per form a form ID delta
+    // and the form's whole keyword list
+    ByteWriter out;
+    out.WriteVarint(3);
+    out.WriteString("Alpha");
+    out.WriteString("Beta");
+    out.WriteString("Gamma");
+    out.WriteVarint(2);
+    out.WriteVarint(5);
+    out.WriteVarint(2);
+    out.WriteVarint(0);
+    out.WriteVarint(1);
+    out.WriteVarint(1000 - 5);
+    out.WriteVarint(1);
+    out.WriteVarint(2);
+
+    MockSerialization save;
+    save.records.push_back({ 'KWPK', 2, std::vector<UInt8>(out.Data(), out.Data() + out.Size()) });
+    mgr->Load(save.Interface());
+
+    // Version 2 keywords are added on top of the INI layer
+    CHECK(mgr->HasKeyword(5, "alpha") && mgr->HasKeyword(5, "BETA") && mgr->HasKeyword(5, "Ini5"));
+    CHECK(mgr->HasKeyword(1000, "Gamma") && mgr->GetKeywordCount(1000) == 1);
+}
+
+static void TestLegacyRecordRead()
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+
+    Legacy::KeywordStore legacy;
+    for (UInt32 formID = 1; formID <= 300; ++formID)
+    {
+        legacy.AddKeyword(formID, "Legacy" + std::to_string(formID % 11));
+        if (formID % 4 == 0) legacy.AddKeyword(formID, "Shared Name");
+    }
+
+    MockSerialization save;
+    legacy.Save(save.Interface());
+    mgr->Load(save.Interface());
+
+    Snapshot expected(legacy.formKeywords.begin(), legacy.formKeywords.end());
+    CHECK(TakeSnapshot(mgr, 300) == expected);
+
+    // A corrupt KWKL length is skipped instead of trusted
+    Snapshot before = TakeSnapshot(mgr, 300);
+    save.Clear();
+    UInt32 formID = 77, one = 1, badLength = 1000;
+    save.Interface()->WriteRecord('KWFM', 1, &formID, sizeof(formID));
+    save.Interface()->WriteRecord('KWKC', 1, &one, sizeof(one));
+    save.Interface()->WriteRecord('KWKL', 1, &badLength, sizeof(badLength));
+    save.Interface()->WriteRecord('KWKD', 1, "abc", 3);
+    TestSDK::ClearLog();
+    mgr->Load(save.Interface());
+    CHECK(TestSDK::LogContains("Skipping corrupt keyword record for form 0000004D"));
+    CHECK(TakeSnapshot(mgr, 300) == before);
+}
+
+static void TestResolveRefID()
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+    mgr->AddKeyword(0x01000800, "Moved");
+    mgr->AddKeyword(0x00000014, "Base");
+
+    MockSerialization save;
+    mgr->Save(save.Interface());
+    mgr->ClearAllKeywords();
+
+    // The mod at index 1 now loads at index 2
+    save.resolve = [](UInt32 refID) {
+        return (refID >> 24) == 1 ? (refID & 0xFFFFFF) | 0x02000000 : refID;
+    };
+    save.Rewind();
+    mgr->Load(save.Interface());
+    CHECK(mgr->HasKeyword(0x02000800, "Moved") && !mgr->HasKeyword(0x01000800, "Moved"));
+    CHECK(mgr->HasKeyword(0x00000014, "Base"));
+}
+
+static void TestCorruptRecords()
+{
+    KeywordManager* mgr = KeywordManager::GetSingleton();
+    mgr->ClearAllKeywords();
+    for (UInt32 formID = 1; formID <= 50; ++formID)
+    {
+        mgr->AddKeyword(formID, "Kw" + std::to_string(formID % 5));
+    }
+
+    MockSerialization save;
+    mgr->Save(save.Interface());
+    const std::vector<UInt8> whole = save.records[0].data;
+
+    // Every truncation loads what it can without reading past the record
+    for (std::size_t size = 0; size < whole.size(); ++size)
+    {
+        save.records[0].data.assign(whole.begin(), whole.begin() + size);
+        save.Rewind();
+        mgr->ClearAllKeywords();
+        TestSDK::ClearLog();
+        mgr->Load(save.Interface());
+        CHECK(TestSDK::LogContains("corrupt") || TestSDK::LogContains("truncated"));
+    }
+
+    // Unknown versions are skipped
+    save.records[0].data = whole;
+    save.records[0].version = 9;
+    save.Rewind();
+    mgr->ClearAllKeywords();
+    TestSDK::ClearLog();
+    mgr->Load(save.Interface());
+    CHECK(TestSDK::LogContains("Skipping keyword record version 9"));
+    CHECK(mgr->GetKeywordCount(1) == 0);
+}
+
+int main()
+{
+    TestDeltaRoundTrip();
+    TestFullRecordRead();
+    TestLegacyRecordRead();
+    TestResolveRefID();
+    TestCorruptRecords();
+
+    if (TestSDK::Failures())
+    {
+        std::fprintf(stderr, "serialization_test: %d check(s) failed\n", TestSDK::Failures());
+        return 1;
+    }
+    std::printf("serialization_test: ok\n");
+    return 0;
+}